@@ -0,0 +1,67 @@
+#ifndef EXPRESSER_ARENA_H
+#define EXPRESSER_ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+
+namespace expresser {
+    // 一次编译使用的单调分配器，Interner、Parser、Function的数据结构都从这里分配
+    // 编译期间只分配不释放，Reset时一次性丢弃
+    // 初始缓冲区在多次编译之间保留，某次编译超出时按超出的量扩大，之后的编译不再向系统申请内存
+    class Arena final {
+    private:
+        // 初始缓冲区用完后的上游，记录超出的字节数
+        class Overflow final : public std::pmr::memory_resource {
+        public:
+            size_t _allocated = 0;
+
+        private:
+            void *do_allocate(size_t bytes, size_t alignment) override {
+                _allocated += bytes;
+                return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+            }
+
+            void do_deallocate(void *p, size_t bytes, size_t alignment) override {
+                std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+            }
+
+            bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+                return this == &other;
+            }
+        };
+
+        size_t _capacity;
+        std::unique_ptr<std::byte[]> _buffer;
+        Overflow _overflow;
+        // monotonic_buffer_resource不能重新指定初始缓冲区，扩大时重新构造
+        std::optional<std::pmr::monotonic_buffer_resource> _resource;
+
+    public:
+        explicit Arena(size_t capacity = 256 * 1024) :
+                _capacity(capacity), _buffer(new std::byte[capacity]) {
+            _resource.emplace(_buffer.get(), _capacity, &_overflow);
+        }
+
+        Arena(const Arena &) = delete;
+        Arena &operator=(const Arena &) = delete;
+
+        std::pmr::memory_resource *Resource() { return &_resource.value(); }
+
+        // 丢弃上一次编译分配的全部内存，调用者保证其中的对象都已析构
+        void Reset() {
+            if (_overflow._allocated == 0) {
+                _resource->release();
+                return;
+            }
+            _resource.reset();
+            _capacity += _overflow._allocated;
+            _overflow._allocated = 0;
+            _buffer.reset(new std::byte[_capacity]);
+            _resource.emplace(_buffer.get(), _capacity, &_overflow);
+        }
+    };
+}
+
+#endif //EXPRESSER_ARENA_H
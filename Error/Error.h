@@ -2,6 +2,7 @@
 #define EXPRESSER_ERROR_H
 
 #include <iostream>
+#include <optional>
 #include <string>
 #include <utility>
 
@@ -68,6 +69,8 @@ namespace expresser {
     private:
         ErrorCode _code;
         position_t _pos;
+        // 出错处在源缓冲区中的字节偏移，报告前由Lexer::Locate换算为行列
+        std::optional<uint32_t> _offset;
     public:
         ExpresserError(position_t position, ErrorCode code) :
                 _code(code), _pos(std::move(position)) {}
@@ -75,15 +78,24 @@ namespace expresser {
         ExpresserError(uint32_t line, uint32_t line_pos, ErrorCode code) :
                 _code(code), _pos({line, line_pos}) {}
 
+        ExpresserError(uint32_t offset, ErrorCode code) :
+                _code(code), _pos({0, 0}), _offset(offset) {}
+
         ExpresserError &operator=(ExpresserError ce) {
             std::swap(*this, ce);
             return *this;
         }
 
-        bool operator==(const ExpresserError &rhs) const { return _pos == rhs._pos && _code == rhs._code; }
+        bool operator==(const ExpresserError &rhs) const {
+            return _pos == rhs._pos && _offset == rhs._offset && _code == rhs._code;
+        }
 
         position_t GetPos() const { return _pos; }
 
+        bool HasOffset() const { return _offset.has_value(); }
+
+        uint32_t GetOffset() const { return _offset.value(); }
+
         ErrorCode GetCode() const { return _code; }
     };
 }
@@ -0,0 +1,117 @@
+#ifndef EXPRESSER_CODESINK_H
+#define EXPRESSER_CODESINK_H
+
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+#include "Error/Error.h"
+#include "Instruction/Instruction.h"
+#include "Instruction/InstructionBuffer.h"
+
+namespace expresser {
+    // 跳转目标，先创建后绑定
+    using label_t = uint32_t;
+
+    // 指令的唯一写入口，.start段和每个函数体各持有一个
+    // 指令下标由CodeSink分配，语法制导翻译不再区分当前在哪一段
+    // 跳转指向label，向前跳转在label绑定时回填，不需要预留NOP
+    class CodeSink final {
+    private:
+        static constexpr uint32_t unbound = UINT32_MAX;
+
+        struct LabelState {
+            // 绑定到的指令下标
+            uint32_t _position;
+            // 等待回填的第一条跳转在_fixups中的下标
+            uint32_t _first_fixup;
+        };
+
+        struct Fixup {
+            // 跳转指令的操作数在_instructions中的位置
+            uint32_t _operand;
+            // 同一label的下一条待回填跳转
+            uint32_t _next;
+        };
+
+        InstructionBuffer _instructions;
+        std::pmr::vector<LabelState> _labels;
+        std::pmr::vector<Fixup> _fixups;
+        // 最后一次绑定label的位置
+        uint32_t _last_bound;
+        // .start段中不能调用函数
+        bool _start_section;
+
+    public:
+        explicit CodeSink(bool start_section = false,
+                          std::pmr::memory_resource *resource = std::pmr::get_default_resource()) :
+                _instructions(resource), _labels(resource), _fixups(resource),
+                _last_bound(unbound), _start_section(start_section) {}
+
+        bool IsStartSection() const { return _start_section; }
+
+        // 下一条指令的下标
+        uint32_t Size() const { return _instructions.Size(); }
+
+        bool Empty() const { return _instructions.Empty(); }
+
+        Instruction Back() const { return _instructions.Back(); }
+
+        const InstructionBuffer &Instructions() const { return _instructions; }
+
+        // 追加一条指令，返回其下标，操作数宽度由操作码决定
+        template<typename... Operands>
+        uint32_t Emit(Operation operation, Operands... operands) {
+            return _instructions.Append(operation, {static_cast<int32_t>(operands)...});
+        }
+
+        // 撤回最后一条指令，用于常量折叠；label只能绑定在被撤回的指令之前
+        void PopBack() {
+            if (_last_bound != unbound && _last_bound >= _instructions.Size())
+                ExceptionPrint("pop instruction behind a label");
+            _instructions.PopBack();
+        }
+
+        label_t NewLabel() {
+            _labels.push_back({unbound, unbound});
+            return _labels.size() - 1;
+        }
+
+        // 跳转到label，label未绑定时先记下，绑定时回填
+        uint32_t EmitJump(Operation operation, label_t label) {
+            auto &state = _labels[label];
+            if (state._position != unbound)
+                return Emit(operation, state._position);
+            auto operand = _instructions.OperandsSize();
+            auto index = Emit(operation, 0);
+            _fixups.push_back({operand, state._first_fixup});
+            state._first_fixup = _fixups.size() - 1;
+            return index;
+        }
+
+        // 把label绑定到下一条指令
+        void Bind(label_t label) {
+            auto &state = _labels[label];
+            if (state._position != unbound)
+                ExceptionPrint("label bound twice");
+            state._position = _instructions.Size();
+            _last_bound = state._position;
+            for (auto fixup = state._first_fixup; fixup != unbound; fixup = _fixups[fixup]._next)
+                _instructions.PatchOperand(_fixups[fixup]._operand, operandWidths(JMP)._first, state._position);
+            state._first_fixup = unbound;
+        }
+
+        // 代码生成结束后由优化pass整体替换，此后不能再使用label
+        void Rewrite(InstructionBuffer instructions) {
+            _instructions = std::move(instructions);
+            _labels.clear();
+            _fixups.clear();
+            _last_bound = unbound;
+        }
+
+        // 有label绑定在末尾时，末尾之后的位置也会被跳转到
+        bool HasLabelAtEnd() const { return _last_bound == _instructions.Size(); }
+    };
+}
+
+#endif //EXPRESSER_CODESINK_H
@@ -1,10 +1,15 @@
 #ifndef EXPRESSER_INSTRUCTION_H
 #define EXPRESSER_INSTRUCTION_H
 
-#include <cstring>
-#include <utility>
+#include <array>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string_view>
+#include <vector>
 
 #include "Types.h"
+#include "Lexer/Token.h"
 
 namespace expresser {
     enum Operation : uint8_t {
@@ -87,71 +92,220 @@ namespace expresser {
             {JNE, JE},
     };
 
-    struct InstructionParam {
-        uint8_t _size{};
-        uint8_t _value[4] = {0};
+    // 各指令操作数的字节数，没有的为0
+    struct OperandWidths {
+        uint8_t _first;
+        uint8_t _second;
+
+        constexpr uint8_t Count() const { return (_first != 0) + (_second != 0); }
     };
 
-    class Instruction {
-    private:
-        uint32_t _index{};
-        Operation _opcode{};
-        std::pair<InstructionParam, InstructionParam> _params;
+    // 弹出或压入的slot数由操作数或被调函数决定
+    constexpr int8_t variable_effect = -1;
 
-    public:
-        Instruction() = default;
+    // 指令规格，编码、解码、汇编输出和栈深度分析都以此为准
+    struct OperationSpec {
+        Operation _opcode;
+        // 为空表示不是合法的操作码
+        std::string_view _mnemonic;
+        OperandWidths _widths;
+        // 弹出、压入的slot数，popn弹出和snew压入的个数为其操作数，call为被调函数的参数和返回值
+        int8_t _pops;
+        int8_t _pushes;
+    };
 
-        Instruction(uint32_t index, Operation _op) {
-            _index = index;
-            _opcode = _op;
-            _params.first._size = 0;
-            _params.second._size = 0;
-        }
+    constexpr OperationSpec operation_specs[] = {
+            {NOP,    "nop",    {0, 0}, 0, 0},
+            {BIPUSH, "bipush", {1, 0}, 0, 1},
+            {IPUSH,  "ipush",  {4, 0}, 0, 1},
+            {POP,    "pop",    {0, 0}, 1, 0},
+            {POP2,   "pop2",   {0, 0}, 2, 0},
+            {POPN,   "popn",   {4, 0}, variable_effect, 0},
+            {DUP,    "dup",    {0, 0}, 1, 2},
+            {DUP2,   "dup2",   {0, 0}, 2, 4},
+            {LOADC,  "loadc",  {2, 0}, 0, 1},
+            {LOADA,  "loada",  {2, 4}, 0, 1},
+            {NEW,    "new",    {0, 0}, 1, 1},
+            {SNEW,   "snew",   {4, 0}, 0, variable_effect},
+            {ILOAD,  "iload",  {0, 0}, 1, 1},
+            {DLOAD,  "dload",  {0, 0}, 1, 2},
+            {ALOAD,  "aload",  {0, 0}, 1, 1},
+            {IALOAD, "iaload", {0, 0}, 2, 1},
+            {DALOAD, "daload", {0, 0}, 2, 2},
+            {AALOAD, "aaload", {0, 0}, 2, 1},
+            {ISTORE, "istore", {0, 0}, 2, 0},
+            {DSTORE, "dstore", {0, 0}, 3, 0},
+            {ASTORE, "astore", {0, 0}, 2, 0},
+            {IASTORE,"iastore",{0, 0}, 3, 0},
+            {DASTORE,"dastore",{0, 0}, 4, 0},
+            {AASTORE,"aastore",{0, 0}, 3, 0},
+            {IADD,   "iadd",   {0, 0}, 2, 1},
+            {DADD,   "dadd",   {0, 0}, 4, 2},
+            {ISUB,   "isub",   {0, 0}, 2, 1},
+            {DSUB,   "dsub",   {0, 0}, 4, 2},
+            {IMUL,   "imul",   {0, 0}, 2, 1},
+            {DMUL,   "dmul",   {0, 0}, 4, 2},
+            {IDIV,   "idiv",   {0, 0}, 2, 1},
+            {DDIV,   "ddiv",   {0, 0}, 4, 2},
+            {INEG,   "ineg",   {0, 0}, 1, 1},
+            {DNEG,   "dneg",   {0, 0}, 2, 2},
+            {ICMP,   "icmp",   {0, 0}, 2, 1},
+            {DCMP,   "dcmp",   {0, 0}, 4, 1},
+            {I2D,    "i2d",    {0, 0}, 1, 2},
+            {D2I,    "d2i",    {0, 0}, 2, 1},
+            {I2C,    "i2c",    {0, 0}, 1, 1},
+            {JMP,    "jmp",    {2, 0}, 0, 0},
+            {JE,     "je",     {2, 0}, 1, 0},
+            {JNE,    "jne",    {2, 0}, 1, 0},
+            {JL,     "jl",     {2, 0}, 1, 0},
+            {JGE,    "jge",    {2, 0}, 1, 0},
+            {JG,     "jg",     {2, 0}, 1, 0},
+            {JLE,    "jle",    {2, 0}, 1, 0},
+            {CALL,   "call",   {2, 0}, variable_effect, variable_effect},
+            {RET,    "ret",    {0, 0}, 0, 0},
+            {IRET,   "iret",   {0, 0}, 1, 0},
+            {DRET,   "dret",   {0, 0}, 2, 0},
+            {ARET,   "aret",   {0, 0}, 1, 0},
+            {IPRINT, "iprint", {0, 0}, 1, 0},
+            {DPRINT, "dprint", {0, 0}, 2, 0},
+            {CPRINT, "cprint", {0, 0}, 1, 0},
+            {SPRINT, "sprint", {0, 0}, 1, 0},
+            {PRINTL, "printl", {0, 0}, 0, 0},
+            {ISCAN,  "iscan",  {0, 0}, 0, 1},
+            {DSCAN,  "dscan",  {0, 0}, 0, 2},
+            {CSCAN,  "cscan",  {0, 0}, 0, 1},
+    };
 
-        Instruction(uint32_t index, Operation _op, uint8_t _size1, int32_t param1) {
-            _index = index;
-            _opcode = _op;
-            _params.first._size = _size1;
-            ::memcpy(_params.first._value, &param1, _size1);
-            _params.second._size = 0;
+    // 以操作码为下标的规格表
+    constexpr auto operation_table = [] {
+        std::array<OperationSpec, 256> table{};
+        for (const auto &spec : operation_specs)
+            table[spec._opcode] = spec;
+        return table;
+    }();
+
+    constexpr bool checkOperationTable() {
+        for (const auto &spec : operation_specs) {
+            // 操作码不能重复
+            if (operation_table[spec._opcode]._mnemonic != spec._mnemonic || spec._mnemonic.empty())
+                return false;
+            // 操作数宽度只能是0、1、2、4，且第二个操作数不能单独存在
+            for (auto width : {spec._widths._first, spec._widths._second})
+                if (width != 0 && width != 1 && width != 2 && width != 4)
+                    return false;
+            if (spec._widths._first == 0 && spec._widths._second != 0)
+                return false;
         }
+        return true;
+    }
+
+    static_assert(checkOperationTable(), "invalid operation_specs");
+
+    constexpr const OperationSpec &operationSpec(Operation operation) {
+        return operation_table[operation];
+    }
+
+    constexpr OperandWidths operandWidths(Operation operation) {
+        return operation_table[operation]._widths;
+    }
+
+    // 编码后的字节数
+    constexpr uint32_t encodedSize(Operation operation) {
+        auto widths = operandWidths(operation);
+        return 1 + widths._first + widths._second;
+    }
 
-        Instruction(uint32_t index, Operation _op, uint8_t _size1, int32_t param1, uint8_t _size2, int32_t param2) {
-            _index = index;
-            _opcode = _op;
-            _params.first._size = _size1;
-            ::memcpy(_params.first._value, &param1, _size1);
-            _params.second._size = _size2;
-            ::memcpy(_params.second._value, &param2, _size2);
+    // 按操作数宽度截断，宽度不足4字节的操作数按无符号数保存
+    constexpr int32_t truncateOperand(int32_t value, uint8_t width) {
+        if (width == 1)
+            return value & 0xff;
+        if (width == 2)
+            return value & 0xffff;
+        return value;
+    }
+
+    constexpr bool isJump(Operation operation) {
+        return operation >= JMP && operation <= JLE;
+    }
+
+    // 大端序写入width字节，返回写入后的位置
+    inline uint8_t *storeBigEndian(uint8_t *out, int32_t value, uint8_t width) {
+        auto bits = static_cast<uint32_t>(value);
+        switch (width) {
+            case 4:
+                *out++ = bits >> 24;
+                *out++ = bits >> 16;
+                [[fallthrough]];
+            case 2:
+                *out++ = bits >> 8;
+                [[fallthrough]];
+            case 1:
+                *out++ = bits;
+                [[fallthrough]];
+            default:
+                return out;
         }
+    }
+
+    // 大端序读出width字节，不足4字节的按无符号数扩展，与truncateOperand一致
+    inline int32_t loadBigEndian(const uint8_t *in, uint8_t width) {
+        uint32_t bits = 0;
+        for (uint8_t i = 0; i < width; i++)
+            bits = (bits << 8) | in[i];
+        return static_cast<int32_t>(bits);
+    }
+
+    // 一条指令的值，由InstructionBuffer按下标构造，不在缓冲区中存放
+    class Instruction final {
+    private:
+        uint32_t _index;
+        Operation _opcode;
+        int32_t _operands[2];
 
-        void SetIndex(uint32_t index) {
-            _index = index;
+    public:
+        Instruction(uint32_t index, Operation opcode, const int32_t *operands) :
+                _index(index), _opcode(opcode), _operands() {
+            for (uint8_t i = 0; i < operandWidths(opcode).Count(); i++)
+                _operands[i] = operands[i];
         }
 
-        uint32_t GetIndex() {
+        uint32_t GetIndex() const {
             return _index;
         }
 
-        Operation GetOperation() {
+        Operation GetOperation() const {
             return _opcode;
         }
 
-        std::pair<InstructionParam, InstructionParam> GetParams() {
-            return _params;
+        uint8_t GetOperandCount() const {
+            return operandWidths(_opcode).Count();
+        }
+
+        int32_t GetOperand(uint8_t i) const {
+            return _operands[i];
+        }
+
+        // 写入encodedSize(操作码)个字节，返回写入后的位置
+        uint8_t *Encode(uint8_t *out) const {
+            auto widths = operandWidths(_opcode);
+            *out++ = _opcode;
+            out = storeBigEndian(out, _operands[0], widths._first);
+            return storeBigEndian(out, _operands[1], widths._second);
         }
 
-        std::vector<uint8_t> ToBinary() {
-            std::vector<uint8_t> result;
-            auto opcode = (uint8_t) _opcode;
-            result.push_back(opcode);
-            if (_params.first._size != 0)
-                for (int i = _params.first._size - 1; i >= 0; i--)
-                    result.push_back(_params.first._value[i]);
-            if (_params.second._size != 0)
-                for (int i = _params.second._size - 1; i >= 0; i--)
-                    result.push_back(_params.second._value[i]);
-            return result;
+        // 执行后栈上slot数的变化，call取决于被调函数，返回空
+        std::optional<int32_t> StackEffect() const {
+            const auto &spec = operationSpec(_opcode);
+            switch (_opcode) {
+                case POPN:
+                    return -_operands[0];
+                case SNEW:
+                    return _operands[0];
+                case CALL:
+                    return {};
+                default:
+                    return spec._pushes - spec._pops;
+            }
         }
     };
 }
@@ -0,0 +1,149 @@
+#ifndef EXPRESSER_INSTRUCTIONBUFFER_H
+#define EXPRESSER_INSTRUCTIONBUFFER_H
+
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <memory_resource>
+#include <optional>
+#include <vector>
+
+#include "Error/Error.h"
+#include "Instruction/Instruction.h"
+
+namespace expresser {
+    // 一段代码的指令，操作码和操作数分别连续存放
+    // 指令的下标即其在_opcodes中的位置，操作数个数和宽度由操作码决定，只存实际有的操作数
+    // 顺序遍历时由操作码推出每条指令的操作数位置
+    class InstructionBuffer final {
+    private:
+        std::pmr::vector<Operation> _opcodes;
+        std::pmr::vector<int32_t> _operands;
+        // 编码后的总字节数
+        uint32_t _encoded_size;
+
+    public:
+        class const_iterator final {
+        private:
+            const InstructionBuffer *_buffer;
+            uint32_t _index;
+            // 当前指令第一个操作数在_operands中的位置
+            uint32_t _operand;
+
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = Instruction;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = Instruction;
+
+            const_iterator(const InstructionBuffer *buffer, uint32_t index, uint32_t operand) :
+                    _buffer(buffer), _index(index), _operand(operand) {}
+
+            Instruction operator*() const {
+                return Instruction(_index, _buffer->_opcodes[_index], _buffer->_operands.data() + _operand);
+            }
+
+            const_iterator &operator++() {
+                _operand += operandWidths(_buffer->_opcodes[_index]).Count();
+                _index++;
+                return *this;
+            }
+
+            bool operator==(const const_iterator &rhs) const { return _index == rhs._index; }
+
+            bool operator!=(const const_iterator &rhs) const { return _index != rhs._index; }
+        };
+
+        explicit InstructionBuffer(std::pmr::memory_resource *resource = std::pmr::get_default_resource()) :
+                _opcodes(resource), _operands(resource), _encoded_size(0) {}
+
+        std::pmr::memory_resource *GetResource() const { return _opcodes.get_allocator().resource(); }
+
+        uint32_t Size() const { return _opcodes.size(); }
+
+        bool Empty() const { return _opcodes.empty(); }
+
+        // 已存放的操作数个数，即下一条指令第一个操作数的位置
+        uint32_t OperandsSize() const { return _operands.size(); }
+
+        uint32_t EncodedSize() const { return _encoded_size; }
+
+        Operation GetOperation(uint32_t index) const { return _opcodes[index]; }
+
+        Instruction Back() const {
+            auto operation = _opcodes.back();
+            return Instruction(_opcodes.size() - 1, operation,
+                               _operands.data() + _operands.size() - operandWidths(operation).Count());
+        }
+
+        // 追加一条指令，返回其下标，操作数个数必须与操作码一致
+        uint32_t Append(Operation operation, std::initializer_list<int32_t> operands) {
+            auto widths = operandWidths(operation);
+            if (operands.size() != widths.Count())
+                ExceptionPrint("operand count mismatch");
+            uint8_t i = 0;
+            for (auto operand : operands)
+                _operands.push_back(truncateOperand(operand, i++ == 0 ? widths._first : widths._second));
+            _opcodes.push_back(operation);
+            _encoded_size += encodedSize(operation);
+            return _opcodes.size() - 1;
+        }
+
+        // 删除最后一条指令
+        void PopBack() {
+            auto operation = _opcodes.back();
+            _operands.resize(_operands.size() - operandWidths(operation).Count());
+            _opcodes.pop_back();
+            _encoded_size -= encodedSize(operation);
+        }
+
+        // 改写_operands中位于position、宽度为width的操作数
+        void PatchOperand(uint32_t position, uint8_t width, int32_t value) {
+            _operands[position] = truncateOperand(value, width);
+        }
+
+        // 解码count条指令追加到末尾，返回读过的字节数，遇到非法操作码或数据不足时返回空
+        std::optional<uint32_t> Decode(const uint8_t *data, uint32_t size, uint32_t count) {
+            uint32_t offset = 0;
+            for (uint32_t i = 0; i < count; i++) {
+                if (offset == size || operation_table[data[offset]]._mnemonic.empty())
+                    return {};
+                auto operation = static_cast<Operation>(data[offset]);
+                if (size - offset < encodedSize(operation))
+                    return {};
+                auto widths = operandWidths(operation);
+                offset++;
+                if (widths._first != 0)
+                    _operands.push_back(loadBigEndian(data + offset, widths._first));
+                offset += widths._first;
+                if (widths._second != 0)
+                    _operands.push_back(loadBigEndian(data + offset, widths._second));
+                offset += widths._second;
+                _opcodes.push_back(operation);
+                _encoded_size += encodedSize(operation);
+            }
+            return offset;
+        }
+
+        // 写入EncodedSize()个字节，返回写入后的位置
+        uint8_t *Encode(uint8_t *out) const {
+            auto operand = _operands.data();
+            for (auto operation : _opcodes) {
+                auto widths = operandWidths(operation);
+                *out++ = operation;
+                if (widths._first != 0)
+                    out = storeBigEndian(out, *operand++, widths._first);
+                if (widths._second != 0)
+                    out = storeBigEndian(out, *operand++, widths._second);
+            }
+            return out;
+        }
+
+        const_iterator begin() const { return const_iterator(this, 0, 0); }
+
+        const_iterator end() const { return const_iterator(this, _opcodes.size(), _operands.size()); }
+    };
+}
+
+#endif //EXPRESSER_INSTRUCTIONBUFFER_H
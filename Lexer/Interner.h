@@ -0,0 +1,52 @@
+#ifndef EXPRESSER_INTERNER_H
+#define EXPRESSER_INTERNER_H
+
+#include <cstring>
+#include <memory_resource>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Types.h"
+
+namespace expresser {
+    // 字符串驻留表，由Lexer在扫描标识符、保留字、字符串字面量时填充，Parser通过符号id查询
+    // 相同的字符串得到相同的id，id从0开始连续分配
+    // 字符串内容和表本身都从传入的memory_resource分配，与之同生命周期
+    class Interner final {
+    private:
+        std::pmr::memory_resource *_resource;
+        // 指向_resource中的字符串内容，地址稳定
+        std::pmr::vector<std::string_view> _strings;
+        std::pmr::unordered_map<std::string_view, symbol_t> _index;
+
+    public:
+        explicit Interner(std::pmr::memory_resource *resource = std::pmr::get_default_resource()) :
+                _resource(resource), _strings(resource), _index(resource) {}
+
+        Interner(const Interner &) = delete;
+        Interner &operator=(const Interner &) = delete;
+
+        symbol_t Intern(std::string_view value) {
+            auto it = _index.find(value);
+            if (it != _index.end())
+                return it->second;
+            auto symbol = static_cast<symbol_t>(_strings.size());
+            auto data = static_cast<char *>(_resource->allocate(value.size(), alignof(char)));
+            std::memcpy(data, value.data(), value.size());
+            const auto &stored = _strings.emplace_back(data, value.size());
+            _index.emplace(stored, symbol);
+            return symbol;
+        }
+
+        std::string_view Get(symbol_t symbol) const {
+            return _strings[symbol];
+        }
+
+        size_t Size() const {
+            return _strings.size();
+        }
+    };
+}
+
+#endif //EXPRESSER_INTERNER_H
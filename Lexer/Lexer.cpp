@@ -1,30 +1,47 @@
+#include <charconv>
 #include <optional>
-#include <regex>
-#include <sstream>
 #include <vector>
 
 #include "Lexer/Lexer.h"
+#include "Lexer/LexerTable.h"
+#include "Lexer/Skip.h"
 #include "Lexer/Utils.hpp"
 
 namespace expresser {
-    Lexer::Lexer(std::istream &input) : _input(input), _is_initialized(false) {}
+    Lexer::Lexer(std::istream &input, Interner &interner) : Lexer(Source(nullptr, 0), interner) {
+        auto res = Source::FromStream(input);
+        if (res.second.has_value()) {
+            _source_error = res.second;
+            return;
+        }
+        _source = std::move(res.first.value());
+        _cursor = _source.Begin();
+    }
+
+    Lexer::Lexer(Source source, Interner &interner) :
+            _source(std::move(source)), _interner(interner), _cursor(_source.Begin()), _past_end(false) {}
+
+    Lexer::Lexer(const char *data, size_t size, Interner &interner) : Lexer(Source(data, size), interner) {}
 
     std::pair<std::optional<Token>, std::optional<ExpresserError>> Lexer::NextToken() {
-        if (!_is_initialized)
-            readAll();
-        if (_input.bad())
-            return std::make_pair(std::optional<Token>(),
-                                  std::make_optional<ExpresserError>(0, 0, ErrorCode::ErrStreamError));
+        if (_source_error.has_value())
+            return std::make_pair(std::optional<Token>(), _source_error);
         if (isEOF())
             return std::make_pair(std::optional<Token>(),
                                   std::make_optional<ExpresserError>(0, 0, ErrorCode::ErrEOF));
-        auto p = nextToken();
-        if (p.second.has_value())
-            return std::make_pair(p.first, p.second);
-        auto err = checkToken(p.first.value());
-        if (err.has_value())
-            return std::make_pair(p.first, err.value());
-        return std::make_pair(p.first, std::optional<ExpresserError>());
+        return nextToken();
+    }
+
+    std::string_view Lexer::GetText(const Token &token) const {
+        return std::string_view(_source.Begin() + token.GetOffset(), token.GetLength());
+    }
+
+    ExpresserError Lexer::Locate(const ExpresserError &error) {
+        if (!error.HasOffset())
+            return error;
+        if (!_line_index.has_value())
+            _line_index.emplace(_source.Begin(), _source.End());
+        return ExpresserError(_line_index->Position(error.GetOffset()), error.GetCode());
     }
 
     std::pair<std::vector<Token>, std::optional<ExpresserError>> Lexer::AllTokens() {
@@ -41,54 +58,54 @@ namespace expresser {
         }
     }
 
-    void Lexer::readAll() {
-        if (_is_initialized)
-            return;
-        for (std::string tmp; std::getline(_input, tmp);)
-            _content_lines.emplace_back(tmp + "\n");
-        _is_initialized = true;
-        _next_char_position = std::make_pair<uint32_t, uint32_t>(0, 0);
-    }
-
     std::pair<std::optional<Token>, std::optional<ExpresserError>> Lexer::nextToken() {
-        std::stringstream ss;
-        std::pair<std::optional<Token>, std::optional<ExpresserError>> result;
-        position_t pos;
+        // token在源缓冲区中的起始位置，token即[begin, _cursor)
+        const char *begin = _cursor;
         DFAState current_state = INITIAL_STATE;
 
         // 辅助函数
+        auto make_token = [&](TokenType type, auto value) {
+            return std::make_pair(std::make_optional<Token>(type, value, begin - _source.Begin(), _cursor - begin),
+                                  std::optional<ExpresserError>());
+        };
         auto return_int = [&]() {
             uint32_t int_value;
-            if (current_state == HEX_STATE)
-                ss >> std::hex >> int_value;
-            else
-                ss >> int_value;
-            if (ss.fail())
+            const char *first = begin;
+            int base = 10;
+            if (current_state == HEX_STATE) {
+                // 跳过'0x'/'0X'
+                if (_cursor - first >= 2 && first[0] == '0' && (first[1] == 'x' || first[1] == 'X'))
+                    first += 2;
+                base = 16;
+            }
+            // 与原先的流提取一致，只转换开头的数字部分
+            auto res = std::from_chars(first, _cursor, int_value, base);
+            if (res.ec == std::errc::result_out_of_range)
+                return errorFactory(ErrorCode::ErrIntegerOverflow);
+            if (res.ec != std::errc())
                 return errorFactory(ErrorCode::ErrInvalidInteger);
-            else
-                return std::make_pair(std::make_optional<Token>(TokenType::INTEGER, *(int32_t *) &int_value, pos, currPos()), std::optional<ExpresserError>());
+            return make_token(TokenType::INTEGER, static_cast<int32_t>(int_value));
         };
         auto return_ident = [&]() {
-            std::string str;
-            ss >> str;
-            if (ss.fail())
-                return errorFactory(ErrorCode::ErrInvalidIdentifier);
-            auto it = reserved_set.find(str);
-            if (it != reserved_set.end())
-                return std::make_pair(std::make_optional<Token>(RESERVED, str, pos, currPos()),
-                                      std::optional<ExpresserError>());
+            std::string_view str(begin, _cursor - begin);
+            auto keyword = lookupKeyword(str);
+            if (keyword != Keyword::NONE)
+                return make_token(RESERVED, keyword);
             else
-                return std::make_pair(std::make_optional<Token>(IDENTIFIER, str, pos, currPos()),
-                                      std::optional<ExpresserError>());
+                return make_token(IDENTIFIER, _interner.Intern(str));
         };
         auto return_double = [&]() {
             double double_literal;
-            ss >> double_literal;
-            if (ss.fail())
+            // 指数部分不完整
+            char last_ch = *(_cursor - 1);
+            if (last_ch == 'e' || last_ch == 'E' || last_ch == '+' || last_ch == '-')
                 return errorFactory(ErrorCode::ErrInvalidDouble);
-            else
-                return std::make_pair(std::make_optional<Token>(TokenType::DOUBLE, double_literal, pos, currPos()),
-                                      std::optional<ExpresserError>());
+            auto res = std::from_chars(begin, _cursor, double_literal);
+            if (res.ec == std::errc::result_out_of_range)
+                return errorFactory(ErrorCode::ErrDoubleOverflow);
+            if (res.ec != std::errc())
+                return errorFactory(ErrorCode::ErrInvalidDouble);
+            return make_token(TokenType::DOUBLE, double_literal);
         };
 
         for (;;) {
@@ -97,84 +114,17 @@ namespace expresser {
                 case INITIAL_STATE: {
                     if (!current_char.has_value())
                         return errorFactory(ErrorCode::ErrEOF);
-                    auto ch = current_char.value();
-                    auto invalid = false;
-
-                    if (expresser::isspace(ch))
-                        current_state = DFAState::INITIAL_STATE;
-                    else if (!expresser::isprint(ch))
-                        invalid = true;
-                    else if (expresser::isdigit(ch))
-                        current_state = DFAState::INTEGER_STATE;
-                    else if (expresser::isalpha(ch))
-                        current_state = DFAState::IDENTIFIER_STATE;
-                    else {
-                        switch (ch) {
-                            case '+':
-                                current_state = PLUS_SIGN_STATE;
-                                break;
-                            case '-':
-                                current_state = MINUS_SIGN_STATE;
-                                break;
-                            case '*':
-                                current_state = MULTIPLICATION_SIGN_STATE;
-                                break;
-                            case '/':
-                                current_state = COMMENT_AND_DIVISION_SIGN_STATE;
-                                break;
-                            case '<':
-                                current_state = LESS_STATE;
-                                break;
-                            case '>':
-                                current_state = GREATER_STATE;
-                                break;
-                            case '=':
-                                current_state = ASSIGN_EQUAL_STATE;
-                                break;
-                            case '!':
-                                current_state = NOTEQUAL_STATE;
-                                break;
-                            case '(':
-                                current_state = LEFTBRACKET_STATE;
-                                break;
-                            case ')':
-                                current_state = RIGHTBRACKET_STATE;
-                                break;
-                            case '{':
-                                current_state = LEFTBRACE_STATE;
-                                break;
-                            case '}':
-                                current_state = RIGHTBRACE_STATE;
-                                break;
-                            case ':':
-                                current_state = COLON_STATE;
-                                break;
-                            case ';':
-                                current_state = SEMICOLON_STATE;
-                                break;
-                            case '\'':
-                                current_state = CHAR_STATE;
-                                break;
-                            case '\"':
-                                current_state = STRING_STATE;
-                                break;
-                            case ',':
-                                current_state = COMMA_STATE;
-                                break;
-                            default: {
-                                invalid = true;
-                                break;
-                            }
-                        }
-                    }
-                    if (current_state != DFAState::INITIAL_STATE) {
-                        pos = prevPos();
-                        ss << ch;
+                    current_state = nextState(INITIAL_STATE, current_char.value());
+                    if (current_state == INITIAL_STATE) {
+                        // 连续的空白一次跳过
+                        _cursor = skipWhitespace(_cursor, _source.End());
+                        break;
                     }
-                    if (invalid) {
+                    if (current_state == INVALID_STATE) {
                         rollback();
                         return errorFactory(ErrorCode::ErrInvalidInput);
                     }
+                    begin = _cursor - 1;
                     break;
                 }
                 case PLUS_SIGN_STATE:
@@ -189,102 +139,47 @@ namespace expresser {
                 case COMMA_STATE: {
                     // 都是单字符的token，所以回退一次返回即可
                     rollback();
-                    char ch;
-                    ss >> ch;
-                    if (ss.fail())
-                        return errorFactory(ErrorCode::ErrInvalidInput);
-                    auto it = simple_token_map.find(ch);
-                    if (it != simple_token_map.end())
-                        return std::make_pair(
-                                std::make_optional<Token>(it->second, std::get<char>(it->first), pos, currPos()),
-                                std::optional<ExpresserError>());
-                    else
-                        return errorFactory(ErrorCode::ErrInvalidCharacter);
+                    return make_token(single_token_table[static_cast<unsigned char>(*begin)], 0);
                 }
                 case LESS_STATE:
                 case GREATER_STATE:
                 case ASSIGN_EQUAL_STATE: {
                     // 预读，如果下一个字符是'='就是LEQ/GEQ/ASSIGN
                     // 否则就是LESS/GREATER/EQUAL
-                    char ch;
                     if (current_char.has_value()) {
-                        ch = current_char.value();
-                        if (ch == '=') {
-                            ss << ch;
-                            std::string str;
-                            ss >> str;
-                            if (ss.fail())
-                                return errorFactory(ErrorCode::ErrInvalidInput);
-                            return makeToken<std::string>(str, pos);
+                        if (current_char.value() == '=') {
+                            return make_token(with_equal_token_table[static_cast<unsigned char>(*begin)], 0);
                         } else {
                             // 回滚
                             rollback();
                         }
                     }
                     // 下一个不是'='，或者下一个为EOF
-                    ss >> ch;
-                    if (ss.fail())
-                        return errorFactory(ErrorCode::ErrInvalidInput);
-                    return makeToken<char>(ch, pos);
+                    return make_token(single_token_table[static_cast<unsigned char>(*begin)], 0);
                 }
                 case NOTEQUAL_STATE: {
                     // 预读，如果不是'='就报错
                     if (current_char.has_value()) {
-                        if (current_char.value() == '=') {
-                            return std::make_pair(
-                                    std::make_optional<Token>(TokenType::NOTEQUAL, std::string("!="), pos, currPos()),
-                                    std::optional<ExpresserError>());
-                        }
+                        if (current_char.value() == '=')
+                            return make_token(TokenType::NOTEQUAL, 0);
                     }
                     return errorFactory(ErrorCode::ErrInvalidNotEqual);
                 }
-                case INTEGER_STATE: {
-                    // 普通 '0'|<nonzero-digit>{<digit>}
-                    // 十六进制 碰到'x'/'X'就跳转 ('0x'|'0X')<hexadecimal-digit>{<hexadecimal-digit>}
-                    // 浮点字面量 碰到'.'就跳转
-                    // 其他报错
-                    for (; current_state == INTEGER_STATE; current_char = nextChar()) {
-                        if (!current_char.has_value()) {
-                            return return_int();
-                        }
-                        char ch = current_char.value();
-                        if (expresser::isdigit(ch)) {
-                            ss << ch;
-                        } else if (ch == 'x' || ch == 'X') {
-                            ss << ch;
-                            current_state = HEX_STATE;
-                            break;
-                        } else if (ch == '.' || ch == 'e' || ch == 'E') {
-                            ss << ch;
-                            current_state = DOUBLE_STATE;
-                            break;
-                        } else if (expresser::isalpha(ch)) {
-                            ss << ch;
-                            current_char = IDENTIFIER_STATE;
-                        } else {
-                            rollback();
-                            return return_int();
-                        }
-                    }
-                    break;
-                }
-                case HEX_STATE: {
-                    // 从INTEGER_STATE跳转而来
-                    for (; current_state == HEX_STATE; current_char = nextChar()) {
-                        if (!current_char.has_value()) {
-                            return return_int();
-                        }
-                        char ch = current_char.value();
-                        if (expresser::isxdigit(ch)) {
-                            ss << ch;
-                        } else if (expresser::isalpha(ch)) {
-                            ss << ch;
-                            current_char = IDENTIFIER_STATE;
-                        } else {
-                            rollback();
-                            return return_int();
-                        }
-                    }
+                case INTEGER_STATE:
+                case HEX_STATE:
+                case IDENTIFIER_STATE: {
+                    // 交还预读的字符，之后按字节查表扫描
+                    // 这些状态不会跨行，可以直接推进游标
+                    rollback();
+                    auto state = current_state;
+                    const char *end = _source.End();
+                    while (_cursor != end && (state = nextState(current_state, *_cursor)) == current_state)
+                        _cursor++;
+                    if (state == current_state || state == ACCEPT_STATE)
+                        return current_state == IDENTIFIER_STATE ? return_ident() : return_int();
+                    // INTEGER_STATE碰到'x'/'X'跳转HEX_STATE，碰到'.'/'e'/'E'跳转DOUBLE_STATE
+                    _cursor++;
+                    current_state = state;
                     break;
                 }
                 case DOUBLE_STATE: {
@@ -302,8 +197,8 @@ namespace expresser {
                     bool has_signal = false;
                     bool has_exponent = false;
 
-                    std::string current_ss = ss.str();
-                    char last_ch = current_ss[current_ss.size() - 1];
+                    // 跳转到本状态的字符，即当前字符的前一个
+                    char last_ch = *(_cursor - 2);
                     if (last_ch == 'e' || last_ch == 'E')
                         has_exponent = true;
 
@@ -312,23 +207,20 @@ namespace expresser {
                             return return_double();
                         }
                         char ch = current_char.value();
-                        if (isdigit(ch)) {
-                            ss << ch;
+                        if (isCharClass(ch, CC_DIGIT)) {
+                            continue;
                         } else if (ch == '.' || (has_exponent && (ch == 'e' || ch == 'E'))) {
                             // 只能有一个exponent，只能有一个小数点
                             // 有exponent后，符号只能接在e/E后
                             return errorFactory(ErrorCode::ErrInvalidDouble);
                         } else if (ch == 'e' || ch == 'E') {
-                            ss << ch;
                             has_exponent = true;
                         } else if (has_exponent && (ch == '+' || ch == '-')) {
                             // 符号不在e/E后就报错
                             // 符号不止一个就报错
-                            current_ss = ss.str();
-                            last_ch = current_ss[current_ss.size() - 1];
+                            last_ch = *(_cursor - 2);
                             if (has_signal || (last_ch != 'e' && last_ch != 'E'))
                                 return errorFactory(ErrorCode::ErrInvalidDouble);
-                            ss << ch;
                             has_signal = true;
                         } else {
                             rollback();
@@ -337,58 +229,32 @@ namespace expresser {
                     }
                     break;
                 }
-                case IDENTIFIER_STATE: {
-                    for (;; current_char = nextChar()) {
-                        if (!current_char.has_value())
-                            return return_ident();
-                        char ch = current_char.value();
-                        if (expresser::isalpha(ch) || expresser::isdigit(ch))
-                            ss << ch;
-                        else {
-                            rollback();
-                            return return_ident();
-                        }
-                    }
-                }
                 case COMMENT_AND_DIVISION_SIGN_STATE: {
                     if (!current_char.has_value() || (current_char.value() != '*' && current_char.value() != '/')) {
                         rollback();
-                        return std::make_pair(std::make_optional<Token>(TokenType::DIVIDE, '/', pos, currPos()),
-                                              std::optional<ExpresserError>());
+                        return make_token(TokenType::DIVIDE, 0);
                     }
                     char ch = current_char.value();
                     if (ch == '*') {
                         // <multi-line-comment> ::=
                         //    '/*'{<any-char>}'*/'
-                        ss.str(std::string(""));
-                        for (; current_state == COMMENT_AND_DIVISION_SIGN_STATE; current_char = nextChar()) {
-                            if (!current_char.has_value())
-                                return errorFactory(ErrorCode::ErrEOF);
-                            else if (current_char.value() == '*') {
-                                // 预读
-                                current_char = nextChar();
-                                if (current_char.has_value() && current_char.value() == '/') {
-                                    // 匹配，返回初始状态
-                                    current_state = INITIAL_STATE;
-                                    break;
-                                } else {
-                                    // 不匹配，回滚
-                                    rollback();
-                                }
-                            }
+                        // 从开头的'*'起查找"*/"，所以"/*/"也是完整的注释
+                        auto comment_end = skipBlockComment(_cursor - 1, _source.End());
+                        if (comment_end == nullptr) {
+                            _cursor = _source.End();
+                            return errorFactory(ErrorCode::ErrEOF);
                         }
+                        // 匹配，返回初始状态
+                        _cursor = comment_end;
+                        current_state = INITIAL_STATE;
                     } else if (ch == '/') {
                         // <single-line-comment> ::=
                         //    '//'{<any-char>}(<LF>|<CR>)
-                        for (; current_state == COMMENT_AND_DIVISION_SIGN_STATE; current_char = nextChar()) {
-                            if (!current_char.has_value() ||
-                                current_char.value() == '\n' ||
-                                current_char.value() == '\r') {
-                                // EOF或者注释结束，返回初始状态
-                                current_state = INITIAL_STATE;
-                                break;
-                            }
-                        }
+                        // 跳到行尾，再读入行尾的换行符
+                        _cursor = skipLineComment(_cursor, _source.End());
+                        nextChar();
+                        // EOF或者注释结束，返回初始状态
+                        current_state = INITIAL_STATE;
                     } else {
                         ExceptionPrint("Unhandled comment!\n");
                     }
@@ -405,12 +271,9 @@ namespace expresser {
                     //<printable> ::=
                     //    <expression> | <string-literal> | <char-literal>
                 case CHAR_STATE: {
-                    if (!current_char.has_value()) {
-                        current_state = INITIAL_STATE;
-                        break;
-                    }
-                    // 清空ss，本部分不使用ss
-                    ss.str(std::string(""));
+                    // 字符字面量未闭合就到了EOF
+                    if (!current_char.has_value())
+                        return errorFactory(ErrorCode::ErrMissingRightQuote);
                     // for EASCII
                     auto ch = current_char.value();
                     auto _result = static_cast<int32_t>(ch);
@@ -475,31 +338,28 @@ namespace expresser {
                     } else {
                         return errorFactory(ErrorCode::ErrInvalidCharacter);
                     }
-                    return std::make_pair(
-                            std::make_optional<Token>(TokenType::CHARLITERAL, _result, pos, currPos()),
-                            std::optional<ExpresserError>());
+                    return make_token(TokenType::CHARLITERAL, _result);
                     break;
                 }
                 case STRING_STATE: {
-                    if (!current_char.has_value()) {
-                        current_state = INITIAL_STATE;
-                        break;
-                    }
-                    std::stringstream stringliteralstream;
+                    // 字符串未闭合就到了EOF，按词法错误报告，不能当作正常的输入结束
+                    if (!current_char.has_value())
+                        return errorFactory(ErrorCode::ErrMissingRightQuote);
+                    std::string literal;
                     for (; current_state == STRING_STATE; current_char = nextChar()) {
-                        char ch = current_char.value();
                         if (!current_char.has_value())
-                            return errorFactory(ErrorCode::ErrEOF);
+                            return errorFactory(ErrorCode::ErrMissingRightQuote);
+                        char ch = current_char.value();
                         if (expresser::isaccch(ch) && ch != '"' && ch != '\\' && ch != '\n' && ch != '\r') {
                             //<s-char>
-                            stringliteralstream << ch;
+                            literal += ch;
                         } else if (ch == '\\') {
                             //<escape-seq> ::=
                             //      '\\' | "\'" | '\"' | '\n' | '\r' | '\t'
                             //    | '\x'<hexadecimal-digit><hexadecimal-digit>
                             current_char = nextChar();
                             if (!current_char.has_value())
-                                return errorFactory(ErrorCode::ErrEOF);
+                                return errorFactory(ErrorCode::ErrMissingRightQuote);
                             ch = current_char.value();
                             if (ch == 'r' || ch == 'n' || ch == 't' || ch == '\\' || ch == '\'' || ch == '"') {
                                 // \{n,r,t,\}
@@ -516,16 +376,16 @@ namespace expresser {
                                     default:
                                         break;
                                 }
-                                stringliteralstream << ch;
+                                literal += ch;
                             } else if (ch == 'x') {
-                                stringliteralstream << '\\';
-                                stringliteralstream << ch;
+                                literal += '\\';
+                                literal += ch;
                                 for (int i = 0; i < 2; i++) {
                                     current_char = nextChar();
                                     if (current_char.has_value()) {
                                         ch = current_char.value();
                                         if (expresser::isxdigit(ch))
-                                            stringliteralstream << ch;
+                                            literal += ch;
                                         else
                                             return errorFactory(ErrorCode::ErrInvalidCharacter);
                                     } else
@@ -538,10 +398,7 @@ namespace expresser {
                         else
                             return errorFactory(ErrorCode::ErrInvalidCharacter);
                     }
-                    std::string val;
-                    val.append(stringliteralstream.str());
-                    return std::make_pair(std::make_optional<Token>(TokenType::STRINGLITERAL, val, pos, currPos()),
-                                          std::optional<ExpresserError>());
+                    return make_token(TokenType::STRINGLITERAL, _interner.Intern(literal));
                     break;
                 }
                 default: {
@@ -553,78 +410,41 @@ namespace expresser {
         return std::make_pair(std::optional<Token>(), std::optional<ExpresserError>());
     }
 
-    std::optional<ExpresserError> Lexer::checkToken(const Token &t) {
-        const static std::regex ident_regex("[a-zA-Z][0-9a-zA-Z]*", std::regex::extended);
-        switch (t.GetType()) {
-            case IDENTIFIER: {
-                std::string val = t.GetStringValue();
-                if (!std::regex_match(val, ident_regex))
-                    return std::make_optional<ExpresserError>(currPos(), ErrorCode::ErrInvalidIdentifier);
-                break;
-            }
-            default:
-                break;
-        }
-        return {};
-    }
-
-    position_t Lexer::prevPos() {
-        if (_next_char_position.first == 0 && _next_char_position.second == 0)
-            ExceptionPrint("current position is file begining, no previous");
-        if (_next_char_position.second == 0)
-            return std::make_pair(_next_char_position.first - 1,
-                                  _content_lines[_next_char_position.first - 1].size() - 1);
-        return std::make_pair(_next_char_position.first, _next_char_position.second - 1);
-    }
-
-    position_t Lexer::currPos() {
-        return _next_char_position;
-    }
-
-    position_t Lexer::nextPos() {
-        if (isEOF() || _next_char_position.first >= _content_lines.size())
-            ExceptionPrint("you are at end of this file");
-        if (_next_char_position.second == _content_lines[_next_char_position.first].size() - 1)
-            return std::make_pair(_next_char_position.first + 1, 0);
-        else
-            return std::make_pair(_next_char_position.first, _next_char_position.second + 1);
+    uint32_t Lexer::currOffset() {
+        return _cursor - _source.Begin();
     }
 
     bool Lexer::isEOF() {
-        return _next_char_position.first >= _content_lines.size();
+        return _cursor == _source.End();
     }
 
     std::optional<char> Lexer::nextChar() {
-        if (isEOF())
+        if (isEOF()) {
+            // 读到EOF也算前进一次，与rollback对应
+            _past_end = true;
             return {};
-        auto res = _content_lines[_next_char_position.first][_next_char_position.second];
-        _next_char_position = nextPos();
-        return res;
+        }
+        return *_cursor++;
     }
 
     std::optional<char> Lexer::peekNext() {
         if (isEOF())
             return {};
-        position_t pos = nextPos();
-        return _content_lines[pos.first][pos.second];
+        return *_cursor;
     }
 
     void Lexer::rollback() {
-        _next_char_position = prevPos();
-    }
-
-    template<typename T>
-    std::pair<std::optional<Token>, std::optional<ExpresserError>> Lexer::makeToken(T value, position_t pos) {
-        auto it = simple_token_map.find(value);
-        if (it != simple_token_map.end())
-            return std::make_pair(std::make_optional<Token>(it->second, std::get<T>(it->first), pos, currPos()),
-                                  std::optional<ExpresserError>());
-        else
-            return std::make_pair(std::optional<Token>(), std::make_optional<ExpresserError>(pos, ErrorCode::ErrInvalidInput));
+        if (_past_end) {
+            _past_end = false;
+            return;
+        }
+        if (_cursor == _source.Begin())
+            ExceptionPrint("current position is file begining, no previous");
+        _cursor--;
     }
 
     std::pair<std::optional<Token>, std::optional<ExpresserError>> Lexer::errorFactory(ErrorCode code) {
         return std::make_pair(std::optional<Token>(),
-                              std::make_optional<ExpresserError>(this->currPos(), code));
+                              std::make_optional<ExpresserError>(currOffset(), code));
     }
 }
\ No newline at end of file
@@ -3,62 +3,49 @@
 
 #include <iostream>
 #include <optional>
+#include <string_view>
 #include <vector>
 
+#include "Lexer/Interner.h"
+#include "Lexer/LineIndex.h"
+#include "Lexer/Source.h"
 #include "Lexer/Token.h"
 #include "Error/Error.h"
 
 namespace expresser {
     class Lexer final {
     private:
-        std::istream &_input;
-        bool _is_initialized;
-        position_t _next_char_position;
-        std::vector<std::string> _content_lines;
+        Source _source;
+        // 标识符、保留字、字符串字面量驻留于此，与Parser共享
+        Interner &_interner;
+        // 读入源代码时的错误，在NextToken时报告
+        std::optional<ExpresserError> _source_error;
+        // 下一个字符
+        const char *_cursor;
+        // 上一次nextChar读到了EOF
+        bool _past_end;
+        // 报告错误时才构建
+        std::optional<LineIndex> _line_index;
 
     public:
-        explicit Lexer(std::istream &input);
+        Lexer(std::istream &input, Interner &interner);
+        Lexer(Source source, Interner &interner);
+        Lexer(const char *data, size_t size, Interner &interner);
         std::pair<std::optional<Token>, std::optional<ExpresserError>> NextToken();
         std::pair<std::vector<Token>, std::optional<ExpresserError>> AllTokens();
+        // token在源缓冲区中的原文
+        std::string_view GetText(const Token &token) const;
+        // 把以字节偏移记录的错误位置换算为行列
+        ExpresserError Locate(const ExpresserError &error);
     private:
-        void readAll();
         std::pair<std::optional<Token>, std::optional<ExpresserError>> nextToken();
-        std::optional<ExpresserError> checkToken(const Token &t);
-        position_t prevPos();
-        position_t currPos();
-        position_t nextPos();
+        uint32_t currOffset();
         std::optional<char> nextChar();
         std::optional<char> peekNext();
         void rollback();
         bool isEOF();
-        template<typename T>
-        std::pair<std::optional<Token>, std::optional<ExpresserError>> makeToken(T value, position_t pos);
         std::pair<std::optional<Token>, std::optional<ExpresserError>> errorFactory(ErrorCode code);
 
-        enum DFAState {
-            INITIAL_STATE,
-            INTEGER_STATE,
-            HEX_STATE,
-            DOUBLE_STATE,
-            PLUS_SIGN_STATE,
-            MINUS_SIGN_STATE,
-            MULTIPLICATION_SIGN_STATE,
-            IDENTIFIER_STATE,
-            SEMICOLON_STATE,
-            COLON_STATE,
-            COMMA_STATE,
-            LEFTBRACKET_STATE,
-            RIGHTBRACKET_STATE,
-            LEFTBRACE_STATE,
-            RIGHTBRACE_STATE,
-            COMMENT_AND_DIVISION_SIGN_STATE,
-            LESS_STATE,
-            GREATER_STATE,
-            ASSIGN_EQUAL_STATE,
-            NOTEQUAL_STATE,
-            CHAR_STATE,
-            STRING_STATE
-        };
     };
 }
 
@@ -0,0 +1,165 @@
+#ifndef EXPRESSER_LEXERTABLE_H
+#define EXPRESSER_LEXERTABLE_H
+
+#include <array>
+#include <cstdint>
+
+#include "Lexer/Token.h"
+
+namespace expresser {
+    enum DFAState : uint8_t {
+        INITIAL_STATE,
+        INTEGER_STATE,
+        HEX_STATE,
+        DOUBLE_STATE,
+        PLUS_SIGN_STATE,
+        MINUS_SIGN_STATE,
+        MULTIPLICATION_SIGN_STATE,
+        IDENTIFIER_STATE,
+        SEMICOLON_STATE,
+        COLON_STATE,
+        COMMA_STATE,
+        LEFTBRACKET_STATE,
+        RIGHTBRACKET_STATE,
+        LEFTBRACE_STATE,
+        RIGHTBRACE_STATE,
+        COMMENT_AND_DIVISION_SIGN_STATE,
+        LESS_STATE,
+        GREATER_STATE,
+        ASSIGN_EQUAL_STATE,
+        NOTEQUAL_STATE,
+        CHAR_STATE,
+        STRING_STATE,
+        // token结束，回退当前字符后接受
+        ACCEPT_STATE,
+        // 非法输入
+        INVALID_STATE,
+        DFA_STATE_COUNT
+    };
+
+    // 字符类别，按位组合；只认ASCII，与C locale下的<cctype>一致
+    enum CharClass : uint8_t {
+        CC_SPACE = 1 << 0,
+        CC_DIGIT = 1 << 1,
+        CC_XDIGIT = 1 << 2,
+        CC_ALPHA = 1 << 3,
+        CC_PRINT = 1 << 4,
+    };
+
+    constexpr auto char_class_table = [] {
+        std::array<uint8_t, 256> table{};
+        for (int ch = 0; ch < 256; ch++) {
+            uint8_t cls = 0;
+            if (ch == ' ' || (ch >= '\t' && ch <= '\r'))
+                cls |= CC_SPACE;
+            if (ch >= '0' && ch <= '9')
+                cls |= CC_DIGIT | CC_XDIGIT;
+            if ((ch >= 'a' && ch <= 'f') || (ch >= 'A' && ch <= 'F'))
+                cls |= CC_XDIGIT;
+            if ((ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z'))
+                cls |= CC_ALPHA;
+            if (ch >= ' ' && ch <= '~')
+                cls |= CC_PRINT;
+            table[ch] = cls;
+        }
+        return table;
+    }();
+
+    constexpr bool isCharClass(char ch, uint8_t cls) {
+        return (char_class_table[static_cast<unsigned char>(ch)] & cls) != 0;
+    }
+
+    // 单字符token及其后接'='时的token，只对相应状态的起始字符有意义
+    struct PunctuatorEntry {
+        char ch;
+        DFAState state;
+        TokenType single;
+        TokenType with_equal;
+    };
+
+    constexpr PunctuatorEntry punctuator_entries[] = {
+            {'+',  PLUS_SIGN_STATE,                 PLUS,         PLUS},
+            {'-',  MINUS_SIGN_STATE,                MINUS,        MINUS},
+            {'*',  MULTIPLICATION_SIGN_STATE,       MULTIPLE,     MULTIPLE},
+            {'/',  COMMENT_AND_DIVISION_SIGN_STATE, DIVIDE,       DIVIDE},
+            {'<',  LESS_STATE,                      LESS,         LESSEQUAL},
+            {'>',  GREATER_STATE,                   GREATER,      GREATEREQUAL},
+            {'=',  ASSIGN_EQUAL_STATE,              ASSIGN,       EQUAL},
+            {'!',  NOTEQUAL_STATE,                  NOTEQUAL,     NOTEQUAL},
+            {'(',  LEFTBRACKET_STATE,               LEFTBRACKET,  LEFTBRACKET},
+            {')',  RIGHTBRACKET_STATE,              RIGHTBRACKET, RIGHTBRACKET},
+            {'{',  LEFTBRACE_STATE,                 LEFTBRACE,    LEFTBRACE},
+            {'}',  RIGHTBRACE_STATE,                RIGHTBRACE,   RIGHTBRACE},
+            {':',  COLON_STATE,                     COLON,        COLON},
+            {';',  SEMICOLON_STATE,                 SEMICOLON,    SEMICOLON},
+            {',',  COMMA_STATE,                     COMMA,        COMMA},
+            {'\'', CHAR_STATE,                      CHARLITERAL,  CHARLITERAL},
+            {'"',  STRING_STATE,                    STRINGLITERAL, STRINGLITERAL},
+    };
+
+    constexpr auto single_token_table = [] {
+        std::array<TokenType, 256> table{};
+        for (auto &entry : punctuator_entries)
+            table[static_cast<unsigned char>(entry.ch)] = entry.single;
+        return table;
+    }();
+
+    constexpr auto with_equal_token_table = [] {
+        std::array<TokenType, 256> table{};
+        for (auto &entry : punctuator_entries)
+            table[static_cast<unsigned char>(entry.ch)] = entry.with_equal;
+        return table;
+    }();
+
+    // 状态转移表：transition_table[state][ch]
+    // 只有INITIAL和按字符连续扫描的状态(INTEGER/HEX/IDENTIFIER)由表驱动，
+    // 其余状态需要上下文（预读、转义、注释），仍由Lexer逐个处理
+    constexpr auto transition_table = [] {
+        std::array<std::array<DFAState, 256>, DFA_STATE_COUNT> table{};
+        for (auto &row : table)
+            for (auto &state : row)
+                state = ACCEPT_STATE;
+
+        for (int ch = 0; ch < 256; ch++) {
+            auto cls = char_class_table[ch];
+            auto &initial = table[INITIAL_STATE][ch];
+            if (cls & CC_SPACE)
+                initial = INITIAL_STATE;
+            else if (cls & CC_DIGIT)
+                initial = INTEGER_STATE;
+            else if (cls & CC_ALPHA)
+                initial = IDENTIFIER_STATE;
+            else
+                initial = INVALID_STATE;
+
+            // 普通 '0'|<nonzero-digit>{<digit>}
+            // 数字后紧跟的字母并入token，转换时只取开头的数字
+            if (cls & (CC_DIGIT | CC_ALPHA))
+                table[INTEGER_STATE][ch] = INTEGER_STATE;
+            // 十六进制 ('0x'|'0X')<hexadecimal-digit>{<hexadecimal-digit>}
+            if (cls & (CC_XDIGIT | CC_ALPHA))
+                table[HEX_STATE][ch] = HEX_STATE;
+            // <identifier> ::= <nondigit>{<nondigit>|<digit>}
+            if (cls & (CC_DIGIT | CC_ALPHA))
+                table[IDENTIFIER_STATE][ch] = IDENTIFIER_STATE;
+        }
+        for (auto &entry : punctuator_entries)
+            table[INITIAL_STATE][static_cast<unsigned char>(entry.ch)] = entry.state;
+
+        table[INTEGER_STATE]['x'] = table[INTEGER_STATE]['X'] = HEX_STATE;
+        table[INTEGER_STATE]['.'] = table[INTEGER_STATE]['e'] = table[INTEGER_STATE]['E'] = DOUBLE_STATE;
+        return table;
+    }();
+
+    constexpr DFAState nextState(DFAState state, char ch) {
+        return transition_table[state][static_cast<unsigned char>(ch)];
+    }
+
+    static_assert(nextState(INITIAL_STATE, '\n') == INITIAL_STATE);
+    static_assert(nextState(INITIAL_STATE, '_') == INVALID_STATE);
+    static_assert(nextState(INTEGER_STATE, 'x') == HEX_STATE);
+    static_assert(nextState(IDENTIFIER_STATE, '9') == IDENTIFIER_STATE);
+    static_assert(nextState(IDENTIFIER_STATE, '.') == ACCEPT_STATE);
+}
+
+#endif //EXPRESSER_LEXERTABLE_H
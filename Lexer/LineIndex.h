@@ -0,0 +1,40 @@
+#ifndef EXPRESSER_LINEINDEX_H
+#define EXPRESSER_LINEINDEX_H
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "Types.h"
+
+namespace expresser {
+    // 行首偏移表，只在需要报告错误位置时构建一次
+    // token和错误只记录字节偏移，由此换算为行列
+    class LineIndex final {
+    private:
+        // 每一行行首在源缓冲区中的偏移，第0行从0开始
+        std::vector<uint32_t> _line_starts;
+
+    public:
+        LineIndex(const char *begin, const char *end) {
+            _line_starts.push_back(0);
+            // memchr按块查找换行符
+            for (auto p = begin; p != end;) {
+                auto newline = static_cast<const char *>(::memchr(p, '\n', end - p));
+                if (newline == nullptr)
+                    break;
+                p = newline + 1;
+                _line_starts.push_back(p - begin);
+            }
+        }
+
+        // 换行符本身属于它所在的行
+        position_t Position(uint32_t offset) const {
+            auto it = std::upper_bound(_line_starts.begin(), _line_starts.end(), offset);
+            uint32_t line = (it - _line_starts.begin()) - 1;
+            return std::make_pair(line, offset - _line_starts[line]);
+        }
+    };
+}
+
+#endif //EXPRESSER_LINEINDEX_H
@@ -0,0 +1,155 @@
+#if defined(__x86_64__)
+
+#include <immintrin.h>
+
+#endif
+
+#include "Lexer/LexerTable.h"
+#include "Lexer/Skip.h"
+
+namespace expresser {
+    namespace {
+        // 逐字节实现，也用于处理向量实现剩下的尾部
+
+        const char *skipWhitespaceScalar(const char *p, const char *end) {
+            while (p != end && isCharClass(*p, CC_SPACE))
+                p++;
+            return p;
+        }
+
+        const char *skipLineCommentScalar(const char *p, const char *end) {
+            while (p != end && *p != '\n' && *p != '\r')
+                p++;
+            return p;
+        }
+
+        const char *skipBlockCommentScalar(const char *p, const char *end) {
+            for (; p != end; p++) {
+                if (*p == '*' && p + 1 != end && *(p + 1) == '/')
+                    return p + 2;
+            }
+            return nullptr;
+        }
+
+#if defined(__x86_64__)
+
+        // ' '或'\t'..'\r'，即(ch - '\t')无符号不超过4
+        inline __m128i isSpace128(__m128i v) {
+            auto offset = _mm_sub_epi8(v, _mm_set1_epi8('\t'));
+            auto control = _mm_cmpeq_epi8(_mm_subs_epu8(offset, _mm_set1_epi8(4)), _mm_setzero_si128());
+            return _mm_or_si128(control, _mm_cmpeq_epi8(v, _mm_set1_epi8(' ')));
+        }
+
+        const char *skipWhitespaceSSE2(const char *p, const char *end) {
+            for (; end - p >= 16; p += 16) {
+                auto v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+                uint32_t space = _mm_movemask_epi8(isSpace128(v));
+                if (space != 0xFFFF)
+                    return p + __builtin_ctz(~space);
+            }
+            return skipWhitespaceScalar(p, end);
+        }
+
+        const char *skipLineCommentSSE2(const char *p, const char *end) {
+            for (; end - p >= 16; p += 16) {
+                auto v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+                uint32_t mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')),
+                                                               _mm_cmpeq_epi8(v, _mm_set1_epi8('\r'))));
+                if (mask != 0)
+                    return p + __builtin_ctz(mask);
+            }
+            return skipLineCommentScalar(p, end);
+        }
+
+        const char *skipBlockCommentSSE2(const char *p, const char *end) {
+            // 同时比较p处的'*'和p+1处的'/'，需要多读一个字节
+            for (; end - p >= 17; p += 16) {
+                auto v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+                auto next = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 1));
+                uint32_t close = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('*')),
+                                                                 _mm_cmpeq_epi8(next, _mm_set1_epi8('/'))));
+                if (close != 0)
+                    return p + __builtin_ctz(close) + 2;
+            }
+            return skipBlockCommentScalar(p, end);
+        }
+
+        __attribute__((target("avx2")))
+        inline __m256i isSpace256(__m256i v) {
+            auto offset = _mm256_sub_epi8(v, _mm256_set1_epi8('\t'));
+            auto control = _mm256_cmpeq_epi8(_mm256_subs_epu8(offset, _mm256_set1_epi8(4)), _mm256_setzero_si256());
+            return _mm256_or_si256(control, _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')));
+        }
+
+        __attribute__((target("avx2")))
+        const char *skipWhitespaceAVX2(const char *p, const char *end) {
+            for (; end - p >= 32; p += 32) {
+                auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+                uint32_t space = _mm256_movemask_epi8(isSpace256(v));
+                if (space != 0xFFFFFFFF)
+                    return p + __builtin_ctz(~space);
+            }
+            return skipWhitespaceSSE2(p, end);
+        }
+
+        __attribute__((target("avx2")))
+        const char *skipLineCommentAVX2(const char *p, const char *end) {
+            for (; end - p >= 32; p += 32) {
+                auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+                uint32_t mask = _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')),
+                                                                     _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r'))));
+                if (mask != 0)
+                    return p + __builtin_ctz(mask);
+            }
+            return skipLineCommentSSE2(p, end);
+        }
+
+        __attribute__((target("avx2")))
+        const char *skipBlockCommentAVX2(const char *p, const char *end) {
+            for (; end - p >= 33; p += 32) {
+                auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+                auto next = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + 1));
+                uint32_t close = _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('*')),
+                                                                       _mm256_cmpeq_epi8(next, _mm256_set1_epi8('/'))));
+                if (close != 0)
+                    return p + __builtin_ctz(close) + 2;
+            }
+            return skipBlockCommentSSE2(p, end);
+        }
+
+#endif
+
+        struct SkipImpl {
+            const char *(*whitespace)(const char *, const char *);
+            const char *(*line_comment)(const char *, const char *);
+            const char *(*block_comment)(const char *, const char *);
+        };
+
+        SkipImpl selectImpl() {
+#if defined(__x86_64__)
+            // 静态初始化阶段调用，需要先初始化CPU信息
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2"))
+                return {skipWhitespaceAVX2, skipLineCommentAVX2, skipBlockCommentAVX2};
+            // x86-64都支持SSE2
+            return {skipWhitespaceSSE2, skipLineCommentSSE2, skipBlockCommentSSE2};
+#else
+            return {skipWhitespaceScalar, skipLineCommentScalar, skipBlockCommentScalar};
+#endif
+        }
+
+        const SkipImpl skip_impl = selectImpl();
+    }
+
+    const char *skipWhitespace(const char *p, const char *end) {
+        return skip_impl.whitespace(p, end);
+    }
+
+    const char *skipLineComment(const char *p, const char *end) {
+        return skip_impl.line_comment(p, end);
+    }
+
+    const char *skipBlockComment(const char *p, const char *end) {
+        return skip_impl.block_comment(p, end);
+    }
+}
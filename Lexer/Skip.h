@@ -0,0 +1,17 @@
+#ifndef EXPRESSER_SKIP_H
+#define EXPRESSER_SKIP_H
+
+namespace expresser {
+    // 批量跳过空白和注释，x86-64上按CPU支持选择AVX2/SSE2实现，其余平台逐字节扫描
+
+    // 返回[p, end)中第一个非空白字符
+    const char *skipWhitespace(const char *p, const char *end);
+
+    // 返回单行注释的结束位置，即第一个'\n'/'\r'，没有则为end
+    const char *skipLineComment(const char *p, const char *end);
+
+    // 返回第一个"*/"之后的位置，没有找到时返回nullptr
+    const char *skipBlockComment(const char *p, const char *end);
+}
+
+#endif //EXPRESSER_SKIP_H
@@ -0,0 +1,84 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <iterator>
+
+#include "Lexer/Source.h"
+
+namespace expresser {
+    Source::Source() : _data(nullptr), _size(0), _mapped_size(0) {}
+
+    Source::Source(const char *data, size_t size) : _data(data), _size(size), _mapped_size(0) {}
+
+    Source::Source(Source &&source) noexcept: Source() {
+        *this = std::move(source);
+    }
+
+    Source &Source::operator=(Source &&source) noexcept {
+        if (this == &source)
+            return *this;
+        release();
+        bool owned = source._mapped_size == 0 && source._data == source._owned.data();
+        _data = source._data;
+        _size = source._size;
+        _mapped_size = source._mapped_size;
+        _owned = std::move(source._owned);
+        if (owned)
+            _data = _owned.data();
+        source._data = nullptr;
+        source._size = 0;
+        source._mapped_size = 0;
+        return *this;
+    }
+
+    Source::~Source() {
+        release();
+    }
+
+    void Source::release() {
+        if (_mapped_size != 0)
+            ::munmap(const_cast<char *>(_data), _mapped_size);
+        _data = nullptr;
+        _size = 0;
+        _mapped_size = 0;
+        _owned.clear();
+    }
+
+    std::pair<std::optional<Source>, std::optional<ExpresserError>> Source::FromFile(const std::string &path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return std::make_pair(std::optional<Source>(), std::make_optional<ExpresserError>(0, 0, ErrStreamError));
+        struct stat st{};
+        if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+            void *addr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr != MAP_FAILED) {
+                ::close(fd);
+                ::madvise(addr, st.st_size, MADV_SEQUENTIAL);
+                Source source;
+                source._data = static_cast<const char *>(addr);
+                source._size = st.st_size;
+                source._mapped_size = st.st_size;
+                return std::make_pair(std::make_optional<Source>(std::move(source)), std::optional<ExpresserError>());
+            }
+        }
+        ::close(fd);
+        // 空文件、管道等无法映射，退化为读入
+        std::ifstream input(path, std::ios::in | std::ios::binary);
+        if (!input)
+            return std::make_pair(std::optional<Source>(), std::make_optional<ExpresserError>(0, 0, ErrStreamError));
+        return FromStream(input);
+    }
+
+    std::pair<std::optional<Source>, std::optional<ExpresserError>> Source::FromStream(std::istream &input) {
+        Source source;
+        source._owned.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+        if (input.bad())
+            return std::make_pair(std::optional<Source>(), std::make_optional<ExpresserError>(0, 0, ErrStreamError));
+        source._data = source._owned.data();
+        source._size = source._owned.size();
+        return std::make_pair(std::make_optional<Source>(std::move(source)), std::optional<ExpresserError>());
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef EXPRESSER_SOURCE_H
+#define EXPRESSER_SOURCE_H
+
+#include <cstddef>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "Error/Error.h"
+
+namespace expresser {
+    // 源代码缓冲区，整个输入连续存放，词法分析直接在其上按字节推进
+    // 来源有三种：mmap映射的文件、从istream读入、调用者持有的缓冲区
+    class Source final {
+    private:
+        const char *_data;
+        size_t _size;
+        // mmap映射的长度，非0时析构需要munmap
+        size_t _mapped_size;
+        // 从istream读入时由自身持有内容
+        std::string _owned;
+
+    public:
+        // 调用者持有的缓冲区，生命周期需长于Source
+        Source(const char *data, size_t size);
+        Source(Source &&source) noexcept;
+        Source &operator=(Source &&source) noexcept;
+        Source(const Source &) = delete;
+        Source &operator=(const Source &) = delete;
+        ~Source();
+
+        static std::pair<std::optional<Source>, std::optional<ExpresserError>> FromFile(const std::string &path);
+        static std::pair<std::optional<Source>, std::optional<ExpresserError>> FromStream(std::istream &input);
+
+        const char *Begin() const { return _data; }
+
+        const char *End() const { return _data + _size; }
+
+        size_t Size() const { return _size; }
+
+    private:
+        Source();
+        void release();
+    };
+}
+
+#endif //EXPRESSER_SOURCE_H
@@ -1,12 +1,11 @@
 #ifndef EXPRESSER_TOKEN_H
 #define EXPRESSER_TOKEN_H
 
-#include <any>
-#include <map>
+#include <array>
 #include <utility>
-#include <variant>
 #include <set>
 #include <string>
+#include <string_view>
 
 #include "Types.h"
 #include "Error/Error.h"
@@ -40,7 +39,22 @@ namespace expresser {
         COMMA,
     };
 
-    const static std::set<std::string> reserved_set{
+    // 保留字，RESERVED类型的token携带
+    enum class Keyword : uint8_t {
+        NONE,
+        CONST,
+        VOID, INT, CHAR, DOUBLE,
+        STRUCT,
+        IF, ELSE,
+        SWITCH, CASE, DEFAULT,
+        WHILE, FOR, DO,
+        RETURN, BREAK, CONTINUE,
+        PRINT, SCAN
+    };
+
+    // 与Keyword一一对应
+    constexpr std::string_view keyword_names[] = {
+            "",
             "const",
             "void", "int", "char", "double",
             "struct",
@@ -51,6 +65,39 @@ namespace expresser {
             "print", "scan"
     };
 
+    // 保留字的完美哈希：由长度、首字符、末字符组合而成，编译期检查无冲突
+    constexpr size_t keyword_table_size = 32;
+
+    constexpr size_t keywordHash(std::string_view word) {
+        return (word.size() * 4 +
+                static_cast<unsigned char>(word.front()) * 4 +
+                static_cast<unsigned char>(word.back()) * 5) % keyword_table_size;
+    }
+
+    constexpr auto keyword_table = [] {
+        std::array<Keyword, keyword_table_size> table{};
+        for (size_t i = 1; i < std::size(keyword_names); i++)
+            table[keywordHash(keyword_names[i])] = static_cast<Keyword>(i);
+        return table;
+    }();
+
+    constexpr bool isPerfectKeywordHash() {
+        for (size_t i = 1; i < std::size(keyword_names); i++)
+            if (keyword_table[keywordHash(keyword_names[i])] != static_cast<Keyword>(i))
+                return false;
+        return true;
+    }
+
+    static_assert(isPerfectKeywordHash(), "keyword hash has collisions");
+
+    // 不是保留字时返回Keyword::NONE
+    constexpr Keyword lookupKeyword(std::string_view word) {
+        if (word.size() < 2 || word.size() > 8)
+            return Keyword::NONE;
+        auto keyword = keyword_table[keywordHash(word)];
+        return keyword_names[static_cast<size_t>(keyword)] == word ? keyword : Keyword::NONE;
+    }
+
     const static std::set<TokenType> relation_token_set{
             LESS,
             GREATER,
@@ -60,75 +107,74 @@ namespace expresser {
             EQUAL
     };
 
-    const static std::map<std::variant<char, std::string>, TokenType> simple_token_map{
-            {'+',  PLUS},
-            {'-',  MINUS},
-            {'*',  MULTIPLE},
-            {'(',  LEFTBRACKET},
-            {')',  RIGHTBRACKET},
-            {'{',  LEFTBRACE},
-            {'}',  RIGHTBRACE},
-            {';',  SEMICOLON},
-            {':',  COLON},
-            {',',  COMMA},
-            {'<',  LESS},
-            {'>',  GREATER},
-            {'=',  ASSIGN},
-            {"<=", LESSEQUAL},
-            {">=", GREATEREQUAL},
-            {"==", EQUAL}
-    };
-
+    // 紧凑的token：类型、字面量值或符号id、在源缓冲区中的位置，共24字节
+    // 行列只在报告错误时由字节偏移换算，token中不保存
+    // 字符串（标识符、保留字、字符串字面量）驻留在Interner中，token中只存符号id
     class Token final {
     private:
         TokenType _type;
-        position_t _start_pos;
-        position_t _end_pos;
-        std::any _value;
+        // 仅RESERVED有效
+        Keyword _keyword;
+        // 原文长度，token不会跨行，但字符串字面量和标识符的长度不设上限
+        uint32_t _length;
+        // 原文在源缓冲区中的偏移
+        uint32_t _offset;
+        union {
+            int32_t _int_value;
+            double _double_value;
+            symbol_t _symbol;
+        };
     public:
         TokenType GetType() const {
             return _type;
         }
 
-        std::any GetValue() const {
-            return _value;
+        int32_t GetIntValue() const {
+            return _int_value;
+        }
+
+        double GetDoubleValue() const {
+            return _double_value;
+        }
+
+        Keyword GetKeyword() const {
+            return _keyword;
+        }
+
+        bool IsKeyword(Keyword keyword) const {
+            return _type == RESERVED && _keyword == keyword;
         }
 
-        std::string GetStringValue() const {
-            try {
-                return std::any_cast<std::string>(_value);
-            }
-            catch (const std::bad_any_cast &) {}
-            try {
-                return std::string(1, std::any_cast<char>(_value));
-            }
-            catch (const std::bad_any_cast &) {}
-            try {
-                return std::to_string(std::any_cast<int32_t>(_value));
-            }
-            catch (const std::bad_any_cast &) {}
-            try {
-                return std::to_string(std::any_cast<double>(_value));
-            }
-            catch (const std::bad_any_cast &) {
-                ExceptionPrint("No suitable cast for token value.");
-            }
-            return "Invalid";
+        // 仅标识符、字符串字面量有符号id
+        symbol_t GetSymbol() const {
+            return _symbol;
         }
 
-        std::pair<uint32_t, uint32_t> GetStartPos() {
-            return _start_pos;
+        bool HasSymbol() const {
+            return _type == IDENTIFIER || _type == STRINGLITERAL;
         }
 
-        std::pair<uint32_t, uint32_t> GetEndPos() {
-            return _end_pos;
+        uint32_t GetOffset() const {
+            return _offset;
+        }
+
+        uint32_t GetLength() const {
+            return _length;
+        }
+
+        // 原文末尾的下一个字节
+        uint32_t GetEndOffset() const {
+            return _offset + _length;
         }
 
         bool operator==(const Token &rhs) const {
-            return _type == rhs._type &&
-                   _start_pos == rhs._start_pos &&
-                   _end_pos == rhs._end_pos &&
-                   GetStringValue() == rhs.GetStringValue();
+            if (_type != rhs._type || _keyword != rhs._keyword || _offset != rhs._offset || _length != rhs._length)
+                return false;
+            if (HasSymbol())
+                return _symbol == rhs._symbol;
+            if (_type == DOUBLE)
+                return _double_value == rhs._double_value;
+            return _int_value == rhs._int_value;
         }
 
         bool operator!=(const Token &rhs) const {
@@ -136,14 +182,27 @@ namespace expresser {
         }
 
     public:
-        Token(TokenType type, std::any value, position_t start_pos, position_t end_pos) :
-                _type(type), _start_pos(std::move(start_pos)), _end_pos(std::move(end_pos)), _value(std::move(value)) {}
+        // 供TokenStream预分配缓冲区
+        Token() : _type(VOID), _keyword(Keyword::NONE), _length(0), _offset(0), _double_value(0) {}
+
+        Token(TokenType type, int32_t value, uint32_t offset, uint32_t length) :
+                _type(type), _keyword(Keyword::NONE), _length(length), _offset(offset), _double_value(0) {
+            _int_value = value;
+        }
+
+        Token(TokenType type, double value, uint32_t offset, uint32_t length) :
+                _type(type), _keyword(Keyword::NONE), _length(length), _offset(offset), _double_value(value) {}
 
-        Token(TokenType type, std::any value, uint32_t start_line, uint32_t start_line_pos,
-              uint32_t end_line, uint32_t end_line_pos) :
-                _type(type), _start_pos(position_t({start_line, start_line_pos})),
-                _end_pos(position_t({end_line, end_line_pos})), _value(std::move(value)) {}
+        Token(TokenType type, symbol_t value, uint32_t offset, uint32_t length) :
+                _type(type), _keyword(Keyword::NONE), _length(length), _offset(offset), _double_value(0) {
+            _symbol = value;
+        }
+
+        Token(TokenType type, Keyword value, uint32_t offset, uint32_t length) :
+                _type(type), _keyword(value), _length(length), _offset(offset), _double_value(0) {}
     };
+
+    static_assert(sizeof(Token) == 24, "Token layout changed");
 }
 
 #endif //EXPRESSER_TOKEN_H
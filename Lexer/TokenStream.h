@@ -0,0 +1,97 @@
+#ifndef EXPRESSER_TOKENSTREAM_H
+#define EXPRESSER_TOKENSTREAM_H
+
+#include <array>
+#include <cstdint>
+#include <optional>
+
+#include "Lexer/Lexer.h"
+#include "Lexer/Token.h"
+#include "Error/Error.h"
+
+namespace expresser {
+    // Parser按需从Lexer拉取token，只在环形缓冲区中保留预读和可回退的少量token
+    // 内存占用与token总数无关，词法分析与语法分析交替进行
+    // Next/Seek返回指向缓冲区的指针，不拷贝token
+    // 指针在之后再读出capacity - max_lookahead个token前保持有效，Parser只在相邻几个token间持有指针
+    class TokenStream final {
+    private:
+        // 容量为2的幂，除预读外剩下的位置保存已读出的token供回退
+        static constexpr uint32_t capacity = 8;
+        static constexpr uint32_t max_lookahead = 3;
+
+        Lexer &_lexer;
+        std::array<Token, capacity> _ring;
+        // 已交给Parser的token数
+        uint32_t _consumed;
+        // 已从Lexer取出的token数
+        uint32_t _lexed;
+        // Lexer已到EOF或出错，不再拉取
+        bool _end;
+        // Lexer报告的错误，EOF不算
+        std::optional<ExpresserError> _error;
+
+    public:
+        explicit TokenStream(Lexer &lexer) : _lexer(lexer), _consumed(0), _lexed(0), _end(false) {}
+
+        TokenStream(const TokenStream &) = delete;
+        TokenStream &operator=(const TokenStream &) = delete;
+
+        // 没有更多token时返回nullptr
+        const Token *Next() {
+            fill(1);
+            if (_lexed == _consumed)
+                return nullptr;
+            return &_ring[_consumed++ % capacity];
+        }
+
+        // 预读第offset个token，offset从1开始
+        const Token *Seek(uint32_t offset) {
+            if (offset == 0 || offset > max_lookahead)
+                ExceptionPrint("lookahead out of range");
+            fill(offset);
+            if (_lexed - _consumed < offset)
+                return nullptr;
+            return &_ring[(_consumed + offset - 1) % capacity];
+        }
+
+        // 已经被覆盖的token无法回退
+        bool Rollback() {
+            if (_consumed == 0 || _lexed - _consumed + 1 > capacity)
+                return false;
+            _consumed--;
+            return true;
+        }
+
+        // 读完剩余的输入，返回Lexer报告的错误
+        std::optional<ExpresserError> Drain() {
+            while (!_end) {
+                auto p = _lexer.NextToken();
+                if (p.second.has_value())
+                    finish(p.second.value());
+            }
+            return _error;
+        }
+
+    private:
+        void fill(uint32_t count) {
+            while (!_end && _lexed - _consumed < count) {
+                auto p = _lexer.NextToken();
+                if (p.second.has_value()) {
+                    finish(p.second.value());
+                    break;
+                }
+                _ring[_lexed++ % capacity] = p.first.value();
+            }
+        }
+
+        void finish(const ExpresserError &error) {
+            _end = true;
+            // ExpresserError只能拷贝构造
+            if (error.GetCode() != ErrorCode::ErrEOF)
+                _error.emplace(error);
+        }
+    };
+}
+
+#endif //EXPRESSER_TOKENSTREAM_H
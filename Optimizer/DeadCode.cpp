@@ -0,0 +1,132 @@
+#include "Optimizer/DeadCode.h"
+
+#include <optional>
+
+namespace expresser {
+    namespace {
+        std::optional<int32_t> pushedConstant(const PassInstruction &instruction) {
+            if (instruction._operation == BIPUSH || instruction._operation == IPUSH)
+                return instruction._operands[0];
+            return {};
+        }
+
+        // 条件跳转对栈顶值value是否跳转
+        bool branchTaken(Operation operation, int32_t value) {
+            switch (operation) {
+                case JE:
+                    return value == 0;
+                case JNE:
+                    return value != 0;
+                case JL:
+                    return value < 0;
+                case JGE:
+                    return value >= 0;
+                case JG:
+                    return value > 0;
+                case JLE:
+                    return value <= 0;
+                default:
+                    return true;
+            }
+        }
+
+        bool fallsThrough(Operation operation) {
+            switch (operation) {
+                case JMP:
+                case RET:
+                case IRET:
+                case DRET:
+                case ARET:
+                    return false;
+                default:
+                    return true;
+            }
+        }
+    }
+
+    bool DeadCode::Run(CodeSink &code) {
+        auto instructions = loadInstructions(code);
+        bool changed = foldBranches(instructions);
+        changed = removeUnreachable(instructions) || changed;
+        if (changed)
+            storeInstructions(code, instructions);
+        return changed;
+    }
+
+    bool DeadCode::foldBranches(std::vector<PassInstruction> &code) {
+        // 只改写，不删除，删除的指令改为nop由后续pass清理
+        auto is_target = jumpTargets(code);
+        bool changed = false;
+        for (uint32_t index = 0; index < code.size(); index++) {
+            auto &branch = code[index];
+            if (!isJump(branch._operation) || branch._operation == JMP)
+                continue;
+            // push c; jcc  或  push a; push b; icmp; jcc，中间的指令不能被跳转到
+            std::optional<int32_t> value;
+            uint32_t first = index;
+            if (index >= 1 && !is_target[index] && (value = pushedConstant(code[index - 1])).has_value()) {
+                first = index - 1;
+            } else if (index >= 3 && !is_target[index] && !is_target[index - 1] && !is_target[index - 2] &&
+                       code[index - 1]._operation == ICMP) {
+                auto lhs = pushedConstant(code[index - 3]), rhs = pushedConstant(code[index - 2]);
+                if (lhs.has_value() && rhs.has_value()) {
+                    value = (lhs.value() > rhs.value()) - (lhs.value() < rhs.value());
+                    first = index - 3;
+                }
+            }
+            if (!value.has_value())
+                continue;
+            bool taken = branchTaken(branch._operation, value.value());
+            for (uint32_t i = first; i < index; i++)
+                code[i] = {NOP, {}};
+            if (taken)
+                branch._operation = JMP;
+            else
+                branch = {NOP, {}};
+            _folded_branches++;
+            changed = true;
+        }
+        return changed;
+    }
+
+    bool DeadCode::removeUnreachable(std::vector<PassInstruction> &code) {
+        auto size = static_cast<uint32_t>(code.size());
+        if (size == 0)
+            return false;
+        std::vector<bool> reachable(size, false);
+        std::vector<uint32_t> worklist{0};
+        reachable[0] = true;
+        auto visit = [&](uint32_t index) {
+            if (index < size && !reachable[index]) {
+                reachable[index] = true;
+                worklist.push_back(index);
+            }
+        };
+        while (!worklist.empty()) {
+            auto index = worklist.back();
+            worklist.pop_back();
+            const auto &instruction = code[index];
+            if (isJump(instruction._operation))
+                visit(instruction._operands[0]);
+            if (fallsThrough(instruction._operation))
+                visit(index + 1);
+        }
+
+        // 可达指令的跳转目标都可达，删除后目标的新下标即其在保留指令中的位置
+        std::vector<uint32_t> new_index(size + 1);
+        std::vector<PassInstruction> result;
+        result.reserve(size);
+        for (uint32_t index = 0; index < size; index++) {
+            new_index[index] = result.size();
+            if (reachable[index])
+                result.push_back(code[index]);
+        }
+        new_index[size] = result.size();
+        if (result.size() == size)
+            return false;
+        _removed_instructions += size - result.size();
+        retargetJumps(result, new_index);
+        code = std::move(result);
+        return true;
+    }
+}
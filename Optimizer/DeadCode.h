@@ -0,0 +1,34 @@
+#ifndef EXPRESSER_DEADCODE_H
+#define EXPRESSER_DEADCODE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "Instruction/CodeSink.h"
+#include "Optimizer/Pass.h"
+
+namespace expresser {
+    // 折叠条件为常量的分支，再从入口沿控制流标记可达指令，删除其余指令
+    // return、break、continue之后的代码，if (0)、while (0)的循环体，以及所有路径都已返回时补上的ret都会被删除
+    class DeadCode final {
+    private:
+        uint32_t _folded_branches;
+        uint32_t _removed_instructions;
+
+    public:
+        DeadCode() : _folded_branches(0), _removed_instructions(0) {}
+
+        // 返回是否修改了代码
+        bool Run(CodeSink &code);
+
+        uint32_t FoldedBranches() const { return _folded_branches; }
+
+        uint32_t RemovedInstructions() const { return _removed_instructions; }
+
+    private:
+        bool foldBranches(std::vector<PassInstruction> &code);
+        bool removeUnreachable(std::vector<PassInstruction> &code);
+    };
+}
+
+#endif //EXPRESSER_DEADCODE_H
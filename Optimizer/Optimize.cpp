@@ -0,0 +1,13 @@
+#include "Optimizer/Optimize.h"
+
+namespace expresser {
+    bool optimizeToFixpoint(CodeSink &code, DeadCode &dead_code, Peephole &peephole) {
+        bool modified = false;
+        for (bool changed = true; changed;) {
+            changed = dead_code.Run(code);
+            changed = peephole.Run(code) || changed;
+            modified = modified || changed;
+        }
+        return modified;
+    }
+}
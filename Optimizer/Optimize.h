@@ -0,0 +1,14 @@
+#ifndef EXPRESSER_OPTIMIZE_H
+#define EXPRESSER_OPTIMIZE_H
+
+#include "Instruction/CodeSink.h"
+#include "Optimizer/DeadCode.h"
+#include "Optimizer/Peephole.h"
+
+namespace expresser {
+    // 两个pass互相产生新的机会，交替运行到不动点
+    // 统计累计在传入的pass中，多段代码可共用同一组pass；返回是否修改了代码
+    bool optimizeToFixpoint(CodeSink &code, DeadCode &dead_code, Peephole &peephole);
+}
+
+#endif //EXPRESSER_OPTIMIZE_H
@@ -0,0 +1,64 @@
+#ifndef EXPRESSER_PASS_H
+#define EXPRESSER_PASS_H
+
+#include <cstdint>
+#include <vector>
+
+#include "Instruction/CodeSink.h"
+#include "Instruction/Instruction.h"
+#include "Instruction/InstructionBuffer.h"
+
+namespace expresser {
+    // 优化pass中可修改的指令，跳转的操作数为目标指令的下标
+    struct PassInstruction {
+        Operation _operation;
+        int32_t _operands[2];
+    };
+
+    inline std::vector<PassInstruction> loadInstructions(const CodeSink &code) {
+        std::vector<PassInstruction> instructions;
+        instructions.reserve(code.Size());
+        for (const auto &instruction : code.Instructions()) {
+            PassInstruction slot{instruction.GetOperation(), {}};
+            for (uint8_t i = 0; i < instruction.GetOperandCount(); i++)
+                slot._operands[i] = instruction.GetOperand(i);
+            instructions.push_back(slot);
+        }
+        return instructions;
+    }
+
+    inline void storeInstructions(CodeSink &code, const std::vector<PassInstruction> &instructions) {
+        InstructionBuffer buffer(code.Instructions().GetResource());
+        for (const auto &slot : instructions) {
+            switch (operandWidths(slot._operation).Count()) {
+                case 0:
+                    buffer.Append(slot._operation, {});
+                    break;
+                case 1:
+                    buffer.Append(slot._operation, {slot._operands[0]});
+                    break;
+                default:
+                    buffer.Append(slot._operation, {slot._operands[0], slot._operands[1]});
+            }
+        }
+        code.Rewrite(std::move(buffer));
+    }
+
+    // 每条指令是否被跳转到，末尾多一项表示跳到代码之后
+    inline std::vector<bool> jumpTargets(const std::vector<PassInstruction> &instructions) {
+        std::vector<bool> is_target(instructions.size() + 1, false);
+        for (const auto &slot : instructions)
+            if (isJump(slot._operation))
+                is_target[slot._operands[0]] = true;
+        return is_target;
+    }
+
+    // 按new_index重定向跳转，new_index以旧下标为下标
+    inline void retargetJumps(std::vector<PassInstruction> &instructions, const std::vector<uint32_t> &new_index) {
+        for (auto &slot : instructions)
+            if (isJump(slot._operation))
+                slot._operands[0] = new_index[slot._operands[0]];
+    }
+}
+
+#endif //EXPRESSER_PASS_H
@@ -0,0 +1,198 @@
+#include "Optimizer/Peephole.h"
+
+namespace expresser {
+    namespace {
+        bool isPurePush(Operation operation) {
+            switch (operation) {
+                case BIPUSH:
+                case IPUSH:
+                case LOADC:
+                case LOADA:
+                case DUP:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        bool isConditionalJump(Operation operation) {
+            return isJump(operation) && operation != JMP;
+        }
+
+        bool isReturn(Operation operation) {
+            return operation == RET || operation == IRET || operation == DRET || operation == ARET;
+        }
+
+        // 沿jmp和nop走到最终落点；跳转链成环时不穿透，返回原目标
+        uint32_t finalTarget(const std::vector<PassInstruction> &code, uint32_t target) {
+            auto current = target;
+            for (size_t hops = 0; hops <= code.size(); hops++) {
+                if (current >= code.size())
+                    return current;
+                const auto &next = code[current];
+                if (next._operation == NOP)
+                    current++;
+                else if (next._operation == JMP)
+                    current = next._operands[0];
+                else
+                    return current;
+            }
+            return target;
+        }
+
+        // nop
+        uint32_t matchNop(const std::vector<PassInstruction> &code, uint32_t index,
+                          std::vector<PassInstruction> &) {
+            return code[index]._operation == NOP ? 1 : 0;
+        }
+
+        // jmp到下一条
+        uint32_t matchJumpToNext(const std::vector<PassInstruction> &code, uint32_t index,
+                                 std::vector<PassInstruction> &) {
+            const auto &jump = code[index];
+            return jump._operation == JMP && jump._operands[0] == (int32_t) index + 1 ? 1 : 0;
+        }
+
+        // 条件跳转到下一条，只需弹出条件
+        uint32_t matchBranchToNext(const std::vector<PassInstruction> &code, uint32_t index,
+                                   std::vector<PassInstruction> &replacement) {
+            const auto &jump = code[index];
+            if (!isConditionalJump(jump._operation) || jump._operands[0] != (int32_t) index + 1)
+                return 0;
+            replacement.push_back({POP, {}});
+            return 1;
+        }
+
+        // jcc L; jmp M; L:  =>  j!cc M
+        uint32_t matchBranchOverJump(const std::vector<PassInstruction> &code, uint32_t index,
+                                     std::vector<PassInstruction> &replacement) {
+            if (index + 1 >= code.size())
+                return 0;
+            const auto &branch = code[index], &jump = code[index + 1];
+            if (!isConditionalJump(branch._operation) || jump._operation != JMP ||
+                branch._operands[0] != (int32_t) index + 2)
+                return 0;
+            replacement.push_back({reverse_map.find(branch._operation)->second, {jump._operands[0]}});
+            return 2;
+        }
+
+        // ipush 0; icmp; jcc  =>  jcc，与0比较的结果和原值同号
+        uint32_t matchCompareZero(const std::vector<PassInstruction> &code, uint32_t index,
+                                  std::vector<PassInstruction> &replacement) {
+            if (index + 2 >= code.size())
+                return 0;
+            const auto &push = code[index];
+            if ((push._operation != IPUSH && push._operation != BIPUSH) || push._operands[0] != 0 ||
+                code[index + 1]._operation != ICMP || !isConditionalJump(code[index + 2]._operation))
+                return 0;
+            replacement.push_back(code[index + 2]);
+            return 3;
+        }
+
+        // 连续两次i2c
+        uint32_t matchDoubleI2C(const std::vector<PassInstruction> &code, uint32_t index,
+                                std::vector<PassInstruction> &replacement) {
+            if (index + 1 >= code.size() || code[index]._operation != I2C || code[index + 1]._operation != I2C)
+                return 0;
+            replacement.push_back(code[index]);
+            return 2;
+        }
+
+        // 跳转到jmp或nop时直接跳到最终落点
+        uint32_t matchThreadJump(const std::vector<PassInstruction> &code, uint32_t index,
+                                 std::vector<PassInstruction> &replacement) {
+            const auto &jump = code[index];
+            if (!isJump(jump._operation))
+                return 0;
+            auto target = finalTarget(code, jump._operands[0]);
+            if (target == (uint32_t) jump._operands[0])
+                return 0;
+            replacement.push_back({jump._operation, {(int32_t) target}});
+            return 1;
+        }
+
+        // jmp到返回指令时直接返回
+        uint32_t matchJumpToReturn(const std::vector<PassInstruction> &code, uint32_t index,
+                                   std::vector<PassInstruction> &replacement) {
+            const auto &jump = code[index];
+            if (jump._operation != JMP || (uint32_t) jump._operands[0] >= code.size() ||
+                !isReturn(code[jump._operands[0]]._operation))
+                return 0;
+            replacement.push_back({code[jump._operands[0]]._operation, {}});
+            return 1;
+        }
+
+        // 压栈后立刻弹出
+        uint32_t matchPushPop(const std::vector<PassInstruction> &code, uint32_t index,
+                              std::vector<PassInstruction> &) {
+            if (index + 1 >= code.size() || !isPurePush(code[index]._operation) || code[index + 1]._operation != POP)
+                return 0;
+            return 2;
+        }
+    }
+
+    const std::array<PeepholeRule, 9> peephole_rules = {{
+            {"nop",                 matchNop},
+            {"jump-to-next",        matchJumpToNext},
+            {"branch-to-next",      matchBranchToNext},
+            {"branch-over-jump",    matchBranchOverJump},
+            {"compare-zero",        matchCompareZero},
+            {"double-i2c",          matchDoubleI2C},
+            {"push-pop",            matchPushPop},
+            {"thread-jump",         matchThreadJump},
+            {"jump-to-return",      matchJumpToReturn},
+    }};
+
+    bool Peephole::Run(CodeSink &code) {
+        auto instructions = loadInstructions(code);
+        if (!rewrite(instructions))
+            return false;
+        while (rewrite(instructions));
+        storeInstructions(code, instructions);
+        return true;
+    }
+
+    bool Peephole::rewrite(std::vector<PassInstruction> &code) {
+        auto size = static_cast<uint32_t>(code.size());
+        // 被跳转到的指令不能出现在窗口中间
+        auto is_target = jumpTargets(code);
+
+        std::vector<PassInstruction> result;
+        result.reserve(code.size());
+        // 旧下标到新下标，被删除的指令映射到其后第一条保留的指令
+        std::vector<uint32_t> new_index(size + 1);
+        std::vector<PassInstruction> replacement;
+        bool changed = false;
+        for (uint32_t index = 0; index < size;) {
+            uint32_t length = 0;
+            for (size_t rule = 0; rule < peephole_rules.size(); rule++) {
+                replacement.clear();
+                length = peephole_rules[rule]._match(code, index, replacement);
+                for (uint32_t i = 1; i < length; i++)
+                    if (is_target[index + i])
+                        length = 0;
+                if (length != 0) {
+                    _hits[rule]++;
+                    break;
+                }
+            }
+            if (length == 0) {
+                new_index[index] = result.size();
+                result.push_back(code[index++]);
+                continue;
+            }
+            changed = true;
+            for (uint32_t i = 0; i < length; i++)
+                new_index[index + i] = result.size();
+            result.insert(result.end(), replacement.begin(), replacement.end());
+            index += length;
+        }
+        new_index[size] = result.size();
+        if (!changed)
+            return false;
+
+        retargetJumps(result, new_index);
+        code = std::move(result);
+        return true;
+    }
+}
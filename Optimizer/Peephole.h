@@ -0,0 +1,46 @@
+#ifndef EXPRESSER_PEEPHOLE_H
+#define EXPRESSER_PEEPHOLE_H
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "Instruction/CodeSink.h"
+#include "Optimizer/Pass.h"
+
+namespace expresser {
+    // 规则在下标为index处匹配时返回窗口长度，并把替换的指令写入replacement；不匹配时返回0
+    // 窗口内除第一条外的指令不能是跳转目标，由Peephole检查；替换中跳转的操作数为旧下标
+    using PeepholeMatcher = uint32_t (*)(const std::vector<PassInstruction> &code, uint32_t index,
+                                         std::vector<PassInstruction> &replacement);
+
+    struct PeepholeRule {
+        std::string_view _name;
+        PeepholeMatcher _match;
+    };
+
+    extern const std::array<PeepholeRule, 9> peephole_rules;
+
+    // 基于规则表的窥孔优化，在代码生成结束后对每段代码重写到不动点
+    // 删除或替换指令后重新编号，跳转到被删除指令的改为跳转到其后第一条保留的指令
+    class Peephole final {
+    private:
+        // 各规则的命中次数，与peephole_rules对应
+        std::array<uint32_t, peephole_rules.size()> _hits;
+
+    public:
+        Peephole() : _hits() {}
+
+        // 返回是否修改了代码
+        bool Run(CodeSink &code);
+
+        const std::array<uint32_t, peephole_rules.size()> &Hits() const { return _hits; }
+
+    private:
+        // 一遍重写，返回是否有规则命中
+        bool rewrite(std::vector<PassInstruction> &code);
+    };
+}
+
+#endif //EXPRESSER_PEEPHOLE_H
@@ -1,85 +1,99 @@
 #include "Parser/Parser.h"
 
+#include <algorithm>
+#include <array>
+#include <cstring>
 #include <utility>
 
 namespace expresser {
-    std::string Constant::ToCode() {
-        std::string result = std::to_string(_index) + " " + _type + " ";
-        switch (_type) {
-            case 'D':
-                result += std::get<double>(_value);
-                break;
-            case 'I':
-                result += std::to_string(std::get<int32_t>(_value));
-                break;
-            case 'S':
-                result += "\"" + std::get<std::string>(_value) + "\"";
-                break;
-            default:
-                ExceptionPrint("Unknown contant type\n");
-                exit(3);
+    namespace {
+        struct BinaryOperator {
+            Operation _operation;
+            // 0表示不是二元运算符
+            uint8_t _precedence;
+        };
+
+        // 二元运算符表，以TokenType为下标
+        constexpr auto binary_operator_table = [] {
+            std::array<BinaryOperator, COMMA + 1> table{};
+            table[PLUS] = {IADD, 1};
+            table[MINUS] = {ISUB, 1};
+            table[MULTIPLE] = {IMUL, 2};
+            table[DIVIDE] = {IDIV, 2};
+            return table;
+        }();
+
+        static_assert(COMMA == 24, "binary_operator_table must cover every TokenType");
+
+        // 按VM的32位补码回绕计算，除数为0和INT32_MIN / -1留到运行时
+        std::optional<int32_t> foldBinary(Operation operation, int32_t lhs, int32_t rhs) {
+            auto a = static_cast<uint32_t>(lhs), b = static_cast<uint32_t>(rhs);
+            switch (operation) {
+                case IADD:
+                    return static_cast<int32_t>(a + b);
+                case ISUB:
+                    return static_cast<int32_t>(a - b);
+                case IMUL:
+                    return static_cast<int32_t>(a * b);
+                case IDIV:
+                    if (rhs == 0 || (lhs == INT32_MIN && rhs == -1))
+                        return {};
+                    return lhs / rhs;
+                default:
+                    return {};
+            }
         }
-        return result;
     }
 
-    std::vector<uint8_t> Constant::ToBinary() {
-        uint8_t *cpy_pointer;
-        std::vector<uint8_t> result;
-        uint8_t type;
+    uint32_t Constant::EncodedSize() const {
+        // 类型1字节，字符串为2字节长度加内容，整型4字节
+        if (_type == 'S')
+            return 1 + 2 + std::get<std::string_view>(_value).length();
+        return 1 + 4;
+    }
+
+    uint8_t *Constant::Encode(uint8_t *out) const {
         switch (_type) {
-            case 'S':
-                type = 0;
-                break;
+            case 'S': {
+                auto string_value = std::get<std::string_view>(_value);
+                *out++ = 0;
+                out = storeBigEndian(out, string_value.length(), 2);
+                ::memcpy(out, string_value.data(), string_value.length());
+                return out + string_value.length();
+            }
             case 'I':
-                type = 1;
-                break;
+                *out++ = 1;
+                return storeBigEndian(out, std::get<int32_t>(_value), 4);
             default:
                 std::cerr << "Unknown constant type" << std::endl;
                 exit(2);
         }
-        result.push_back(type);
-        if (type == 0) {
-            auto string_value = std::get<std::string>(_value);
-            auto string_length = (uint16_t) string_value.length();
-            cpy_pointer = (uint8_t *) &string_length;
-            for (int i = 1; i >= 0; i--)
-                result.push_back(cpy_pointer[i]);
-            for (uint8_t ch:string_value)
-                result.push_back(ch);
-        } else {
-            auto *value_pointer = (uint8_t *) &std::get<int32_t>(_value);
-            for (int i = 3; i >= 0; i--)
-                result.push_back(value_pointer[i]);
-        }
-        return result;
     }
 
-    std::vector<uint8_t> Function::ToBinary() {
-        uint8_t *cpy_pointer;
-        std::vector<uint8_t> result;
-
-        cpy_pointer = (uint8_t *) &_name_index;
-        for (int i = 1; i >= 0; i--)
-            result.push_back(cpy_pointer[i]);
-
-        cpy_pointer = (uint8_t *) &_params_size;
-        for (int i = 1; i >= 0; i--)
-            result.push_back(cpy_pointer[i]);
-
-        cpy_pointer = (uint8_t *) &_level;
-        for (int i = 1; i >= 0; i--)
-            result.push_back(cpy_pointer[i]);
+    uint32_t Function::EncodedSize() const {
+        // name_index、params_size、level、指令数各2字节
+        return 2 * 4 + _code.Instructions().EncodedSize();
+    }
 
-        auto instrument_count = _instructions.size();
-        cpy_pointer = (uint8_t *) &instrument_count;
-        for (int i = 1; i >= 0; i--)
-            result.push_back(cpy_pointer[i]);
+    uint8_t *Function::Encode(uint8_t *out) const {
+        out = storeBigEndian(out, _name_index, 2);
+        out = storeBigEndian(out, _params_size, 2);
+        out = storeBigEndian(out, _level, 2);
+        out = storeBigEndian(out, _code.Size(), 2);
+        return _code.Instructions().Encode(out);
+    }
 
-        for (auto instrument:_instructions) {
-            auto instrument_binary = instrument.ToBinary();
-            result.insert(result.end(), instrument_binary.begin(), instrument_binary.end());
-        }
-        return result;
+    std::vector<const Function *> Parser::FunctionsInOrder() const {
+        std::vector<std::pair<int32_t, symbol_t>> function_information;
+        function_information.reserve(_functions.size());
+        for (const auto &function:_functions)
+            function_information.emplace_back(function.second._index, function.first);
+        std::sort(function_information.begin(), function_information.end());
+        std::vector<const Function *> functions;
+        functions.reserve(function_information.size());
+        for (const auto &it:function_information)
+            functions.push_back(&_functions.find(it.second)->second);
+        return functions;
     }
 
     std::optional<ExpresserError> Parser::Parse() {
@@ -89,217 +103,109 @@ namespace expresser {
         return {};
     }
 
-    std::optional<Token> Parser::nextToken() {
-        if (_offset == _tokens.size())
-            return {};
-        _current_pos = _tokens[_offset].GetEndPos();
-        return _tokens[_offset++];
+    std::optional<ExpresserError> Parser::LexerError() {
+        return _tokens.Drain();
     }
 
-    std::optional<Token> Parser::seekToken(int32_t offset) {
-        if (_offset + offset - 1 >= _tokens.size())
-            return {};
-        return _tokens[_offset + offset - 1];
+    const Token *Parser::nextToken() {
+        auto token = _tokens.Next();
+        if (token != nullptr)
+            _current_offset = token->GetEndOffset();
+        return token;
+    }
+
+    const Token *Parser::seekToken(int32_t offset) {
+        return _tokens.Seek(offset);
     }
 
     void Parser::rollback() {
-        if (_offset <= 0) {
+        if (!_tokens.Rollback()) {
             std::cerr << "Cannot rollback" << std::endl;
             exit(2);
         }
-        _offset--;
     }
 
-    template<typename T>
-    std::optional<ExpresserError> Parser::addGlobalConstant(const std::string &constant_name, const char type, T value) {
-        if (isGlobalVariable(constant_name))
-            return errorFactory(ErrorCode::ErrDuplicateDeclaration);
-        // 一般只用来字符串
+    int32_t Parser::addStringConstant(symbol_t value) {
+        // 相同的字符串只在常量池中放一份
+        auto it = _global_constants_index.find(value);
+        if (it != _global_constants_index.end())
+            return it->second;
         int32_t index = _global_constants.size();
-        _global_constants.emplace_back(Constant(index, type, value));
-        _global_constants_index.insert({constant_name, index});
-        return {};
+        _global_constants.emplace_back(index, 'S', _interner.Get(value));
+        _global_constants_index.insert({value, index});
+        return index;
     }
 
-    std::optional<ExpresserError> Parser::addGlobalConstant(const std::string &variable_name, TokenType type) {
-        if (isGlobalVariable(variable_name))
+    std::optional<ExpresserError> Parser::addGlobalConstant(symbol_t variable_name, TokenType type) {
+        if (_symbols.IsDeclared(variable_name))
             return errorFactory(ErrorCode::ErrDuplicateDeclaration);
-        // 只负责加入_global_stack_constants
-        auto index = _start_instruments.size();
-        _start_instruments.emplace_back(Instruction(index, Operation::SNEW, 4, 1));
-        _global_stack_constants.insert({variable_name, _global_sp++});
-        _global_type_map.insert({variable_name, type});
+        // 全局堆栈上分配全局常量，由随后的初始化赋值
+        _start_code.Emit(Operation::SNEW, 1);
+        _symbols.Declare(variable_name, _global_sp++, type, true, true);
         return {};
     }
 
     std::optional<ExpresserError>
-    Parser::addGlobalVariable(const std::string &variable_name, TokenType type) {
-        if (isGlobalVariable(variable_name))
+    Parser::addGlobalVariable(symbol_t variable_name, TokenType type) {
+        if (_symbols.IsDeclared(variable_name))
             return errorFactory(ErrorCode::ErrDuplicateDeclaration);
         // 全局堆栈上分配全局变量
         // 无初始值，用snew
-        auto index = _start_instruments.size();
-        _start_instruments.emplace_back(Instruction(index, Operation::SNEW, 4, 1));
-        _global_uninitialized.insert({variable_name, _global_sp++});
-        _global_type_map.insert({variable_name, type});
+        _start_code.Emit(Operation::SNEW, 1);
+        _symbols.Declare(variable_name, _global_sp++, type, false, false);
         return {};
     }
 
     std::pair<Function *, std::optional<ExpresserError>>
-    Parser::addFunction(const std::string &function_name, const TokenType &return_type, const std::vector<FunctionParam> &params) {
-        auto err = addGlobalConstant(function_name, 'S', function_name);
-        if (err.has_value())
-            return std::make_pair(nullptr, err.value());
-        Function function(_functions.size(), _global_constants_index.find(function_name)->second, params.size(), return_type, params);
-        // 把参数信息放入函数变量、常量表中
-        for (size_t i = 0; i < params.size(); i++) {
-            auto p = params[i];
-            if (p._is_const)
-                function._local_constants.insert({p._value, i});
-            else
-                function._local_vars.insert({p._value, i});
-            function._local_type_map.insert({p._value, p._type});
+    Parser::addFunction(symbol_t function_name, const TokenType &return_type, std::pmr::vector<FunctionParam> params) {
+        // 函数名与全局变量、常量在同一作用域
+        if (_symbols.IsDeclared(function_name))
+            return std::make_pair(nullptr, errorFactory(ErrorCode::ErrDuplicateDeclaration));
+        auto name_index = addStringConstant(function_name);
+        _symbols.Declare(function_name, name_index, return_type, true, true, true);
+        int32_t params_size = params.size();
+        auto &function = _functions.insert_or_assign(
+                function_name, Function(_functions.size(), name_index, params_size, return_type, std::move(params)))
+                .first->second;
+        // 进入函数作用域，参数是最先声明的局部量，重名时以第一个为准
+        _symbols.EnterScope();
+        for (size_t i = 0; i < function._params.size(); i++) {
+            auto &p = function._params[i];
+            _symbols.Declare(p._value, i, p._type, p._is_const, true);
         }
-        _functions[function_name] = function;
-        return std::make_pair(&_functions[function_name], std::optional<ExpresserError>());
+        return std::make_pair(&function, std::optional<ExpresserError>());
     }
 
     std::optional<ExpresserError>
-    Parser::addLocalConstant(Function &function, TokenType type, const std::string &constant_name) {
-        if (isLocalVariable(function, constant_name))
+    Parser::addLocalConstant(Function &function, TokenType type, symbol_t constant_name) {
+        if (_symbols.IsDeclared(constant_name))
             return errorFactory(ErrorCode::ErrDuplicateDeclaration);
         // 局部堆栈上分配局部常量
-        auto index = function._instructions.size();
-        function._instructions.emplace_back(Instruction(index, Operation::SNEW, 4, 1));
-        function._local_constants.insert({constant_name, function._local_sp++});
-        function._local_type_map.insert({constant_name, type});
+        function._code.Emit(Operation::SNEW, 1);
+        _symbols.Declare(constant_name, function._local_sp++, type, true, true);
         return {};
     }
 
     std::optional<ExpresserError>
-    Parser::addLocalVariable(Function &function, TokenType type, const std::string &variable_name) {
-        if (isLocalVariable(function, variable_name))
+    Parser::addLocalVariable(Function &function, TokenType type, symbol_t variable_name) {
+        if (_symbols.IsDeclared(variable_name))
             return errorFactory(ErrorCode::ErrDuplicateDeclaration);
         // 局部堆栈上分配局部变量
         // 无初始值，用snew
-        auto index = function._instructions.size();
-        function._instructions.emplace_back(Instruction(index, Operation::SNEW, 4, 1));
-        function._local_uninitialized.insert({variable_name, function._local_sp++});
-        function._local_type_map.insert({variable_name, type});
+        function._code.Emit(Operation::SNEW, 1);
+        _symbols.Declare(variable_name, function._local_sp++, type, false, false);
         return {};
     }
 
-    std::pair<std::optional<int32_t>, std::optional<ExpresserError>>
-    Parser::getIndex(const std::string &variable_name) {
-        int32_t res = -1;
-        if (isGlobalVariable(variable_name)) {
-            if (_global_constants_index.find(variable_name) != _global_constants_index.end())
-                res = _global_constants_index[variable_name];
-            else if (_global_stack_constants.find(variable_name) != _global_stack_constants.end())
-                res = _global_stack_constants[variable_name];
-            else if (_global_uninitialized.find(variable_name) != _global_uninitialized.end())
-                res = _global_uninitialized[variable_name];
-            else
-                res = _global_variables[variable_name];
-        }
-        if (res != -1)
-            return std::make_pair(std::make_optional<int32_t>(res), std::optional<ExpresserError>());
-        return std::make_pair(std::optional<int32_t>(), errorFactory(ErrorCode::ErrUndeclaredIdentifier));
-    }
-
-    std::pair<std::optional<int32_t>, std::optional<ExpresserError>> Parser::getIndex(Function &function, const std::string &variable_name) {
-        // 先在本函数的变量区、常量区找，后在全局常量区找
-        int32_t res = -1;
-        if (isLocalVariable(function, variable_name)) {
-            if (function._local_constants.find(variable_name) != function._local_constants.end())
-                res = function._local_constants[variable_name];
-            else if (function._local_uninitialized.find(variable_name) != function._local_uninitialized.end())
-                res = function._local_uninitialized[variable_name];
-            else
-                res = function._local_vars[variable_name];
-        } else if (isGlobalVariable(variable_name)) {
-            return getIndex(variable_name);
-        }
-        if (res != -1)
-            return std::make_pair(std::make_optional<int32_t>(res), std::optional<ExpresserError>());
-        return std::make_pair(std::optional<int32_t>(), errorFactory(ErrorCode::ErrUndeclaredIdentifier));
-    }
-
-    std::pair<Function *, std::optional<ExpresserError>> Parser::getFunction(const std::string &function_name) {
+    std::pair<Function *, std::optional<ExpresserError>> Parser::getFunction(symbol_t function_name) {
         auto it = _functions.find(function_name);
         if (it == _functions.end())
             return std::make_pair(nullptr, errorFactory(ErrorCode::ErrUndeclaredFunction));
         return std::make_pair(&it->second, std::optional<ExpresserError>());
     }
 
-    bool Parser::isGlobalVariable(const std::string &variable_name) {
-        return isGlobalInitializedVariable(variable_name) ||
-               isGlobalUnInitializedVariable(variable_name) ||
-               isGlobalConstant(variable_name);
-    }
-
-    bool Parser::isGlobalInitializedVariable(const std::string &variable_name) {
-        return _global_variables.find(variable_name) != _global_variables.end();
-    }
-
-    bool Parser::isGlobalUnInitializedVariable(const std::string &variable_name) {
-        return _global_uninitialized.find(variable_name) != _global_uninitialized.end();
-    }
-
-    bool Parser::isGlobalConstant(const std::string &variable_name) {
-        return _global_constants_index.find(variable_name) != _global_constants_index.end() ||
-               _global_stack_constants.find(variable_name) != _global_stack_constants.end();
-    }
-
-    bool Parser::isLocalVariable(Function &function, const std::string &variable_name) {
-        return isLocalInitializedVariable(function, variable_name) ||
-               isLocalUnInitializedVariable(function, variable_name) ||
-               isLocalConstant(function, variable_name);
-    }
-
-    bool Parser::isLocalInitializedVariable(Function &function, const std::string &variable_name) {
-        return function._local_vars.find(variable_name) != function._local_vars.end();
-    }
-
-    bool Parser::isLocalUnInitializedVariable(Function &function, const std::string &variable_name) {
-        return function._local_uninitialized.find(variable_name) != function._local_uninitialized.end();
-    }
-
-    bool Parser::isLocalConstant(Function &function, const std::string &variable_name) {
-        return function._local_constants.find(variable_name) != function._local_constants.end();
-    }
-
-    bool Parser::isInitialized(Function &function, const std::string &variable_name) {
-        return isLocalInitializedVariable(function, variable_name) || isGlobalInitializedVariable(variable_name);
-    }
-
-    bool Parser::isUnInitialized(Function &function, const std::string &variable_name) {
-        return isLocalUnInitializedVariable(function, variable_name) && isGlobalUnInitializedVariable(variable_name);
-    }
-
-    bool Parser::isConstant(Function &function, const std::string &variable_name) {
-        if (isLocalVariable(function, variable_name))
-            return isLocalConstant(function, variable_name);
-        return isGlobalConstant(variable_name);
-    }
-
-    std::optional<TokenType> Parser::getVariableType(const std::string &variable_name) {
-        auto it = _global_type_map.find(variable_name);
-        if (it != _global_type_map.end())
-            return it->second;
-        return std::optional<TokenType>();
-    }
-
-    std::optional<TokenType> Parser::getVariableType(Function &function, const std::string &variable_name) {
-        auto it = function._local_type_map.find(variable_name);
-        if (it != function._local_type_map.end())
-            return it->second;
-        return std::optional<TokenType>();
-        return {};
-    }
-
     std::optional<ExpresserError> Parser::errorFactory(ErrorCode code) {
-        return std::make_optional<ExpresserError>(_current_pos, code);
+        return std::make_optional<ExpresserError>(_current_offset, code);
     }
 
     // 语法制导翻译
@@ -325,53 +231,53 @@ namespace expresser {
         // 0个或无数个
         for (;;) {
             auto token = nextToken();
-            if (!token.has_value())
+            if (token == nullptr)
                 return {};
-            if (token->GetType() == RESERVED && token->GetStringValue() == std::string("const")) {
+            if (token->IsKeyword(Keyword::CONST)) {
                 // TYPE
                 token = nextToken();
-                if (!token.has_value())
+                if (token == nullptr)
                     return errorFactory(ErrorCode::ErrConstantNeedValue);
                 // 只会是int/char中一种
-                TokenType const_type = stringTypeToTokenType(token->GetStringValue()).value();
+                TokenType const_type = keywordToTokenType(token->GetKeyword()).value();
                 for (;;) {
                     // IDENTFIER
                     token = nextToken();
-                    if (!token.has_value() || token->GetType() != IDENTIFIER)
+                    if (token == nullptr || token->GetType() != IDENTIFIER)
                         return errorFactory(ErrorCode::ErrNeedIdentifier);
-                    std::string identifier = token->GetStringValue();
-                    if (isGlobalVariable(identifier))
-                        return errorFactory(ErrorCode::ErrDuplicateDeclaration);
-                    addGlobalConstant(identifier, const_type);
+                    symbol_t identifier = token->GetSymbol();
+                    auto err = addGlobalConstant(identifier, const_type);
+                    if (err.has_value())
+                        return err;
 
                     // =
                     token = nextToken();
-                    if (!token.has_value() || token->GetType() != ASSIGN)
+                    if (token == nullptr || token->GetType() != ASSIGN)
                         return errorFactory(ErrorCode::ErrNeedAssignSymbol);
 
                     // LOADA取地址
-                    auto const_index = getIndex(identifier).first.value();
-                    auto index = _start_instruments.size();
-                    _start_instruments.emplace_back(Instruction(index, Operation::LOADA, 2, 0, 4, const_index));
+                    auto const_index = _global_sp - 1;
+                    _start_code.Emit(Operation::LOADA, 0, const_index);
 
                     // 解析<expression>
-                    auto res = parseExpression(nullptr);
+                    auto res = parseExpression(_start_code);
                     if (res.second.has_value())
                         return res.second.value();
                     auto expr_type = res.first.value();
                     if (const_type == CHARLITERAL && expr_type == INTEGER) {
-                        index = _start_instruments.size();
-                        _start_instruments.emplace_back(Instruction(index, Operation::I2C));
+                        _start_code.Emit(Operation::I2C);
+                    } else {
+                        // 存入的值在编译期已知，引用处折叠
+                        _symbols.Resolve(identifier)->_value = _expression_value;
                     }
 
                     // ISTORE存回
                     // 此时栈顶为<expression>结果，次栈顶为LOADA取出的地址
-                    index = _start_instruments.size();
-                    _start_instruments.emplace_back(Instruction(index, Operation::ISTORE));
+                    _start_code.Emit(Operation::ISTORE);
 
                     // , or ;
                     token = nextToken();
-                    if (token.has_value()) {
+                    if (token != nullptr) {
                         if (token->GetType() == SEMICOLON)
                             break;
                         if (token->GetType() == COMMA)
@@ -380,29 +286,29 @@ namespace expresser {
                     // 不是分号逗号、或者has_value为假
                     return errorFactory(ErrorCode::ErrNeedSemicolonOrComma);
                 }
-            } else if (token->GetType() == RESERVED && isVariableType(token.value())) {
+            } else if (token->GetType() == RESERVED && isVariableType(*token)) {
                 // 超前扫描，确认是否是函数的声明
                 auto seek = seekToken(2);
-                if (seek.has_value() && seek->GetType() == LEFTBRACKET) {
+                if (seek != nullptr && seek->GetType() == LEFTBRACKET) {
                     // 回滚一个token
                     rollback();
                     return {};
                 }
-                TokenType var_type = stringTypeToTokenType(token->GetStringValue()).value();
+                TokenType var_type = keywordToTokenType(token->GetKeyword()).value();
                 for (;;) {
                     // IDENTFIER
                     token = nextToken();
-                    if (!token.has_value() || token->GetType() != IDENTIFIER)
+                    if (token == nullptr || token->GetType() != IDENTIFIER)
                         return errorFactory(ErrorCode::ErrNeedIdentifier);
-                    auto identifier = token->GetStringValue();
-                    if (isGlobalVariable(identifier))
-                        return errorFactory(ErrorCode::ErrDuplicateDeclaration);
+                    symbol_t identifier = token->GetSymbol();
                     // snew分配空间，因为不支持double所以slot为4
-                    addGlobalVariable(identifier, var_type);
+                    auto err = addGlobalVariable(identifier, var_type);
+                    if (err.has_value())
+                        return err;
 
                     // =
                     token = nextToken();
-                    if (!token.has_value())
+                    if (token == nullptr)
                         return errorFactory(ErrorCode::ErrEOF);
                     else if (token->GetType() == COMMA)
                         continue;
@@ -410,34 +316,27 @@ namespace expresser {
                         break;
                     else if (token->GetType() == ASSIGN) {
                         // 加载预分配空间在栈中地址
-                        auto index = _start_instruments.size();
                         auto var_index = _global_sp - 1;
-                        _start_instruments.emplace_back(Instruction(index, Operation::LOADA, 2, 0, 4, var_index));
+                        _start_code.Emit(Operation::LOADA, 0, var_index);
 
                         // 解析<expression>
-                        auto res = parseExpression({});
+                        auto res = parseExpression(_start_code);
                         if (res.second.has_value())
                             return res.second.value();
                         auto expr_type = res.first.value();
                         if (var_type == CHARLITERAL && expr_type == INTEGER) {
-                            index = _start_instruments.size();
-                            _start_instruments.emplace_back(Instruction(index, Operation::I2C));
+                            _start_code.Emit(Operation::I2C);
                         }
 
                         // 此时全局栈的栈顶就是结果，次栈顶是目标地址
                         // istore
-                        index = _start_instruments.size();
-                        _start_instruments.emplace_back(Instruction(index, Operation::ISTORE));
-                        // 移出未初始化表
-                        auto it = _global_uninitialized.find(identifier);
-                        // 移入_global_variables
-                        _global_variables.insert({it->first, it->second});
-                        // 移出_global_uninitialized
-                        _global_uninitialized.erase(identifier);
+                        _start_code.Emit(Operation::ISTORE);
+                        // 标记为已初始化
+                        _symbols.Resolve(identifier)->_initialized = true;
 
                         // , or ;
                         token = nextToken();
-                        if (token.has_value()) {
+                        if (token != nullptr) {
                             if (token->GetType() == SEMICOLON)
                                 break;
                             if (token->GetType() == COMMA)
@@ -473,29 +372,29 @@ namespace expresser {
 
         // <type-specifier>
         auto token = nextToken();
-        if (!token.has_value()) {
+        if (token == nullptr) {
             _program_end = true;
             return {};
         }
-        if (token->GetType() != TokenType::RESERVED || !isFunctionReturnType(token.value()))
+        if (token->GetType() != TokenType::RESERVED || !isFunctionReturnType(*token))
             return errorFactory(ErrorCode::ErrInvalidFunctionReturnType);
-        auto type = stringTypeToTokenType(token->GetStringValue());
+        auto type = keywordToTokenType(token->GetKeyword());
         if (!type.has_value())
             return errorFactory(ErrorCode::ErrInvalidFunctionReturnType);
         auto return_type = type.value();
 
         // <identifier>
         token = nextToken();
-        if (!token.has_value() || token->GetType() != TokenType::IDENTIFIER)
+        if (token == nullptr || token->GetType() != TokenType::IDENTIFIER)
             return errorFactory(ErrorCode::ErrNeedIdentifier);
-        auto function_name = token->GetStringValue();
+        auto function_name = token->GetSymbol();
 
         // <parameter-clause>
-        std::vector<FunctionParam> params;
+        std::pmr::vector<FunctionParam> params(_resource);
         auto err = parseParameterDeclarations(params);
         if (err.has_value())
             return err.value();
-        auto res = addFunction(function_name, return_type, params);
+        auto res = addFunction(function_name, return_type, std::move(params));
         if (res.second.has_value())
             return res.second.value();
 
@@ -504,21 +403,25 @@ namespace expresser {
         err = parseCompoundStatement(*function);
         if (err.has_value())
             return err.value();
+        // 离开函数作用域
+        _symbols.LeaveScope();
 
         // 如果最后没有ret/iret/dret/aret
         // 添加ret，避免无法跳出
-        auto index = function->_instructions.size();
-        auto it = function->_instructions[index - 1];
-        if (it.GetOperation() != RET &&
-            it.GetOperation() != IRET &&
-            it.GetOperation() != DRET &&
-            it.GetOperation() != ARET)
-            function->_instructions.emplace_back(Instruction(index, Operation::RET));
+        // 末尾被跳转到时同样需要
+        auto &code = function->_code;
+        if (code.Empty() || code.HasLabelAtEnd()) {
+            code.Emit(Operation::RET);
+        } else {
+            auto last = code.Back().GetOperation();
+            if (last != RET && last != IRET && last != DRET && last != ARET)
+                code.Emit(Operation::RET);
+        }
 
         return {};
     }
 
-    std::optional<ExpresserError> Parser::parseParameterDeclarations(std::vector<FunctionParam> &params) {
+    std::optional<ExpresserError> Parser::parseParameterDeclarations(std::pmr::vector<FunctionParam> &params) {
         //<parameter-clause> ::=
         //    '(' [<parameter-declaration-list>] ')'
         //<parameter-declaration-list> ::=
@@ -527,43 +430,43 @@ namespace expresser {
         //    [<const-qualifier>]<type-specifier><identifier>
         auto token = nextToken();
         // 左括号
-        if (!token.has_value() || token->GetType() != LEFTBRACKET)
+        if (token == nullptr || token->GetType() != LEFTBRACKET)
             return errorFactory(ErrorCode::ErrMissingBracket);
         token = nextToken();
         auto seek = seekToken(1);
-        if (seek.has_value() && seek->GetType() == RIGHTBRACKET) {
+        if (seek != nullptr && seek->GetType() == RIGHTBRACKET) {
             // 无参数
             nextToken();
             return {};
         }
         for (;; token = nextToken()) {
-            if (!token.has_value())
+            if (token == nullptr)
                 return errorFactory(ErrorCode::ErrEOF);
             else if (token->GetType() == RIGHTBRACKET)
                 // 右括号，退出
                 break;
             else if (token->GetType() == RESERVED &&
-                     (isVariableType(token.value()) || token->GetStringValue() == "const")) {
+                     (isVariableType(*token) || token->IsKeyword(Keyword::CONST))) {
                 bool is_const = false;
-                if (token->GetStringValue() == "const") {
+                if (token->IsKeyword(Keyword::CONST)) {
                     token = nextToken();
-                    if (!token.has_value())
+                    if (token == nullptr)
                         return errorFactory(ErrorCode::ErrEOF);
-                    if (token->GetType() != RESERVED || !isVariableType(token.value()))
+                    if (token->GetType() != RESERVED || !isVariableType(*token))
                         return errorFactory(ErrorCode::ErrInvalidVariableType);
                     is_const = true;
                 }
                 // <类型><标识符>
-                auto param_type = stringTypeToTokenType(token->GetStringValue()).value();
+                auto param_type = keywordToTokenType(token->GetKeyword()).value();
                 token = nextToken();
-                if (!token.has_value() || token->GetType() != IDENTIFIER)
+                if (token == nullptr || token->GetType() != IDENTIFIER)
                     return errorFactory(ErrorCode::ErrNeedIdentifier);
-                params.emplace_back(FunctionParam(param_type, token->GetStringValue(), is_const));
+                params.emplace_back(param_type, token->GetSymbol(), is_const);
                 // 逗号继续
                 // 右括号退出
                 // 其他报错
                 token = nextToken();
-                if (!token.has_value())
+                if (token == nullptr)
                     return errorFactory(ErrorCode::ErrEOF);
                 else if (token->GetType() == RIGHTBRACKET)
                     break;
@@ -583,7 +486,7 @@ namespace expresser {
         //<statement-seq> ::=
         //	{<statement>}
         auto token = nextToken();
-        if (!token.has_value() || token->GetType() != LEFTBRACE)
+        if (token == nullptr || token->GetType() != LEFTBRACE)
             return errorFactory(ErrorCode::ErrMissingBrace);
         auto err = parseLocalVariableDeclarations(function);
         if (err.has_value())
@@ -592,7 +495,7 @@ namespace expresser {
         if (err.has_value())
             return err;
         token = nextToken();
-        if (!token.has_value() || token->GetType() != RIGHTBRACE)
+        if (token == nullptr || token->GetType() != RIGHTBRACE)
             return errorFactory(ErrorCode::ErrMissingBrace);
         return {};
     }
@@ -609,47 +512,44 @@ namespace expresser {
         // seekToken预读
         for (;;) {
             auto token = nextToken();
-            if (!token.has_value())
+            if (token == nullptr)
                 return {};
 
-            auto function_name = std::get<std::string>(_global_constants[function._name_index]._value);
-            if (token->GetType() == RESERVED && token->GetStringValue() == "const") {
+            if (token->IsKeyword(Keyword::CONST)) {
                 // const
                 token = nextToken();
-                if (!token.has_value())
+                if (token == nullptr)
                     return errorFactory(ErrorCode::ErrConstantNeedValue);
-                TokenType const_type = stringTypeToTokenType(token->GetStringValue()).value();
+                TokenType const_type = keywordToTokenType(token->GetKeyword()).value();
                 for (;;) {
                     token = nextToken();
-                    if (!token.has_value() || token->GetType() != IDENTIFIER)
+                    if (token == nullptr || token->GetType() != IDENTIFIER)
                         return errorFactory(ErrorCode::ErrNeedIdentifier);
-                    std::string identifier = token->GetStringValue();
-                    if (isLocalVariable(function, identifier))
-                        return errorFactory(ErrorCode::ErrDuplicateDeclaration);
-                    addLocalConstant(function, const_type, identifier);
+                    symbol_t identifier = token->GetSymbol();
+                    auto err = addLocalConstant(function, const_type, identifier);
+                    if (err.has_value())
+                        return err;
 
                     token = nextToken();
-                    if (!token.has_value() || token->GetType() != ASSIGN)
+                    if (token == nullptr || token->GetType() != ASSIGN)
                         return errorFactory(ErrorCode::ErrNeedAssignSymbol);
 
-                    auto const_index = getIndex(function, identifier).first.value();
-                    auto index = function._instructions.size();
-                    function._instructions.emplace_back(Instruction(index, Operation::LOADA, 2, 0, 4, const_index));
+                    auto const_index = function._local_sp - 1;
+                    function._code.Emit(Operation::LOADA, 0, const_index);
 
-                    auto res = parseExpression(&function);
+                    auto res = parseExpression(function._code);
                     if (res.second.has_value())
                         return res.second.value();
                     auto expr_type = res.first.value();
                     if (const_type == CHARLITERAL && expr_type == INTEGER) {
-                        index = function._instructions.size();
-                        function._instructions.emplace_back(Instruction(index, Operation::I2C));
+                        function._code.Emit(Operation::I2C);
+                    } else {
+                        _symbols.Resolve(identifier)->_value = _expression_value;
                     }
-
-                    index = function._instructions.size();
-                    function._instructions.emplace_back(Instruction(index, Operation::ISTORE));
+                    function._code.Emit(Operation::ISTORE);
 
                     token = nextToken();
-                    if (token.has_value()) {
+                    if (token != nullptr) {
                         if (token->GetType() == SEMICOLON)
                             break;
                         if (token->GetType() == COMMA)
@@ -658,59 +558,51 @@ namespace expresser {
                     // 不是分号逗号、或者has_value为假
                     return errorFactory(ErrorCode::ErrNeedSemicolonOrComma);
                 }
-            } else if (token->GetType() == RESERVED && isVariableType(token.value())) {
+            } else if (token->GetType() == RESERVED && isVariableType(*token)) {
                 // var or func
                 // 预读判断函数
                 auto seek = seekToken(2);
-                if (seek.has_value() && seek->GetType() == LEFTBRACKET) {
+                if (seek != nullptr && seek->GetType() == LEFTBRACKET) {
                     // 回滚一个token
                     rollback();
                     return {};
                 }
-                auto vartype_res = stringTypeToTokenType(token->GetStringValue());
+                auto vartype_res = keywordToTokenType(token->GetKeyword());
                 if (!vartype_res.has_value())
                     return errorFactory(ErrorCode::ErrInvalidVariableType);
                 TokenType var_type = vartype_res.value();
                 for (;;) {
                     token = nextToken();
-                    if (!token.has_value() || token->GetType() != IDENTIFIER)
+                    if (token == nullptr || token->GetType() != IDENTIFIER)
                         return errorFactory(ErrorCode::ErrNeedIdentifier);
-                    auto identifier = token->GetStringValue();
-                    if (isLocalVariable(function, identifier))
-                        return errorFactory(ErrorCode::ErrDuplicateDeclaration);
-                    addLocalVariable(function, var_type, identifier);
+                    symbol_t identifier = token->GetSymbol();
+                    auto err = addLocalVariable(function, var_type, identifier);
+                    if (err.has_value())
+                        return err;
 
                     token = nextToken();
-                    if (!token.has_value())
+                    if (token == nullptr)
                         return errorFactory(ErrorCode::ErrEOF);
                     else if (token->GetType() == COMMA)
                         continue;
                     else if (token->GetType() == SEMICOLON)
                         break;
                     else if (token->GetType() == ASSIGN) {
-                        auto index = function._instructions.size();
                         auto var_index = function._local_sp - 1;
-                        function._instructions.emplace_back(Instruction(index, Operation::LOADA, 2, 0, 4, var_index));
+                        function._code.Emit(Operation::LOADA, 0, var_index);
 
-                        auto res = parseExpression(&function);
+                        auto res = parseExpression(function._code);
                         if (res.second.has_value())
                             return res.second.value();
                         auto expr_type = res.first.value();
                         if (var_type == CHARLITERAL && expr_type == INTEGER) {
-                            index = function._instructions.size();
-                            function._instructions.emplace_back(Instruction(index, Operation::I2C));
-                        }
-
-                        index = function._instructions.size();
-                        function._instructions.emplace_back(Instruction(index, Operation::ISTORE));
-                        auto it = function._local_uninitialized.find(identifier);
-                        if (it != function._local_uninitialized.end()) {
-                            function._local_vars.insert({it->first, it->second});
-                            function._local_uninitialized.erase(identifier);
+                            function._code.Emit(Operation::I2C);
                         }
+                        function._code.Emit(Operation::ISTORE);
+                        _symbols.Resolve(identifier)->_initialized = true;
 
                         token = nextToken();
-                        if (token.has_value()) {
+                        if (token != nullptr) {
                             if (token->GetType() == SEMICOLON)
                                 break;
                             if (token->GetType() == COMMA)
@@ -755,7 +647,7 @@ namespace expresser {
     std::pair<bool, std::optional<ExpresserError>> Parser::parseStatement(Function &function) {
         bool statement_end = false;
         auto token = nextToken();
-        if (!token.has_value())
+        if (token == nullptr)
             return std::make_pair(statement_end, errorFactory(ErrorCode::ErrEOF));
         if (token->GetType() == RIGHTBRACE) {
             // 右括号，函数结束
@@ -766,46 +658,48 @@ namespace expresser {
             if (err.has_value())
                 return std::make_pair(statement_end, err.value());
             token = nextToken();
-            if (!token.has_value() || token->GetType() != RIGHTBRACE)
+            if (token == nullptr || token->GetType() != RIGHTBRACE)
                 return std::make_pair(statement_end, errorFactory(ErrorCode::ErrMissingBrace));
-        } else if (token->GetType() == RESERVED && token->GetStringValue() == "if") {
-            rollback();
-            auto err = parseConditionStatement(function);
-            if (err.has_value())
-                return std::make_pair(statement_end, err.value());
-        } else if (token->GetType() == RESERVED &&
-                   (token->GetStringValue() == "do" || token->GetStringValue() == "while")) {
-            rollback();
-            auto err = parseLoopStatement(function);
-            if (err.has_value())
-                return std::make_pair(statement_end, err.value());
-        } else if (token->GetType() == RESERVED &&
-                   (token->GetStringValue() == "return" ||
-                    token->GetStringValue() == "continue" ||
-                    token->GetStringValue() == "break")) {
-            rollback();
-            auto err = parseJumpStatement(function);
-            if (err.has_value())
-                return std::make_pair(statement_end, err.value());
-        } else if (token->GetType() == RESERVED && token->GetStringValue() == "print") {
-            rollback();
-            auto err = parsePrintStatement(function);
-            if (err.has_value())
-                return std::make_pair(statement_end, err.value());
-        } else if (token->GetType() == RESERVED && token->GetStringValue() == "scan") {
-            rollback();
-            auto err = parseScanStatement(function);
+        } else if (token->GetType() == RESERVED) {
+            std::optional<ExpresserError> err;
+            switch (token->GetKeyword()) {
+                case Keyword::IF:
+                    rollback();
+                    err = parseConditionStatement(function);
+                    break;
+                case Keyword::DO:
+                case Keyword::WHILE:
+                    rollback();
+                    err = parseLoopStatement(function);
+                    break;
+                case Keyword::RETURN:
+                case Keyword::CONTINUE:
+                case Keyword::BREAK:
+                    rollback();
+                    err = parseJumpStatement(function);
+                    break;
+                case Keyword::PRINT:
+                    rollback();
+                    err = parsePrintStatement(function);
+                    break;
+                case Keyword::SCAN:
+                    rollback();
+                    err = parseScanStatement(function);
+                    break;
+                default:
+                    return std::make_pair(statement_end, errorFactory(ErrorCode::ErrInvalidStatement));
+            }
             if (err.has_value())
                 return std::make_pair(statement_end, err.value());
         } else if (token->GetType() == IDENTIFIER) {
             // function call or assign
             auto seek = seekToken(1);
             std::optional<ExpresserError> err;
-            if (!seek.has_value())
+            if (seek == nullptr)
                 return std::make_pair(statement_end, errorFactory(ErrorCode::ErrEOF));
             rollback();
             if (seek->GetType() == LEFTBRACKET) {
-                auto res = parseFunctionCall(&function);
+                auto res = parseFunctionCall(function._code);
                 err = res.second;
             } else {
                 err = parseAssignmentExpression(function);
@@ -828,20 +722,18 @@ namespace expresser {
         // |    condition-lhs   |
         // |    condition-rhs   |
         // |       compare      |
-        // |    jmp-1->nop-2    | -> 条件不符合时跳转
+        // |   jmp-1->else/end  | -> 条件不符合时跳转
         // | ------------------ |
         // |     <if-block>     |
-        // | nop-1/jmp-2->nop-3 | -> 有else块时无条件跳转
-        // |        nop-2       |
-        // | ------------------ | -> 可能不存在
+        // |     jmp-2->end     | -> 只在有else块时存在
+        // | ------------------ | -> else
         // |    <else-block>    |
-        // |        nop-3       |
-        // | ------------------ |
+        // | ------------------ | -> end
         // 跳过'if'
         nextToken();
         // (
         auto token = nextToken();
-        if (!token.has_value() || token->GetType() != LEFTBRACKET)
+        if (token == nullptr || token->GetType() != LEFTBRACKET)
             return errorFactory(ErrorCode::ErrMissingBracket);
 
         // <condition>
@@ -852,12 +744,12 @@ namespace expresser {
         token = nextToken();
 
         // )
-        if (!token.has_value() || token->GetType() != RIGHTBRACKET)
+        if (token == nullptr || token->GetType() != RIGHTBRACKET)
             return errorFactory(ErrorCode::ErrMissingBracket);
 
-        // 预留位置，待<statement>解析完毕后修改
-        auto jmp_index = function._instructions.size();
-        function._instructions.emplace_back(jmp_index, Operation::NOP);
+        auto &code = function._code;
+        auto else_label = code.NewLabel();
+        code.EmitJump(operation, else_label);
 
         // <statement>
         // if块
@@ -865,30 +757,20 @@ namespace expresser {
         if (err.second.has_value())
             return err.second.value();
 
-        // if块末尾添加两个nop
-        // 第一个nop用于有else时跳过else块
-        // 第二个nop用于条件不符合时跳入else块
-        // 条件不符合时JMP目标的位置
-        auto nop_index = function._instructions.size();
-        // NOP1
-        function._instructions.emplace_back(nop_index, Operation::NOP);
-        // NOP2
-        function._instructions.emplace_back(nop_index + 1, Operation::NOP);
-        // 修改原来的JMP
-        function._instructions[jmp_index] = Instruction(jmp_index, operation, 2, nop_index + 1);
-
         // 预读,else块
         auto seek = seekToken(1);
-        if (seek.has_value() && seek->GetType() == RESERVED && seek->GetStringValue() == "else") {
+        if (seek != nullptr && seek->IsKeyword(Keyword::ELSE)) {
             nextToken();
+            // if块执行完跳过else块
+            auto end_label = code.NewLabel();
+            code.EmitJump(Operation::JMP, end_label);
+            code.Bind(else_label);
             err = parseStatement(function);
             if (err.second.has_value())
                 return err.second.value();
-            auto index = function._instructions.size();
-            // 修改if块末尾第一个nop，防止执行到else块
-            // NOP3
-            function._instructions.emplace_back(Instruction(index, Operation::NOP));
-            function._instructions[nop_index] = Instruction(nop_index, Operation::JMP, 2, index);
+            code.Bind(end_label);
+        } else {
+            code.Bind(else_label);
         }
         return {};
     }
@@ -898,35 +780,33 @@ namespace expresser {
         //    <expression>[<relational-operator><expression>]
         Operation operation;
         // LHS
-        auto res = parseExpression(&function);
+        auto res = parseExpression(function._code);
         if (res.second.has_value())
             return std::make_pair(std::optional<Operation>(), res.second.value());
 
         auto seek = seekToken(1);
-        if (seek.has_value() && seek->GetType() == RIGHTBRACKET) {
+        if (seek != nullptr && seek->GetType() == RIGHTBRACKET) {
             // LHS==0 跳过if块
             operation = Operation::JE;
             // CODE
-            auto index = function._instructions.size();
-            function._instructions.emplace_back(Instruction(index, Operation::IPUSH, 4, 0));
-            function._instructions.emplace_back(Instruction(index + 1, Operation::ICMP));
+            function._code.Emit(Operation::IPUSH, 0);
+            function._code.Emit(Operation::ICMP);
             return std::make_pair(std::make_optional<Operation>(operation), std::optional<ExpresserError>());
         } else {
             // 关系符号
             auto token = nextToken();
-            if (!token.has_value() || relation_token_set.find(token->GetType()) == relation_token_set.end())
+            if (token == nullptr || relation_token_set.find(token->GetType()) == relation_token_set.end())
                 return std::make_pair(std::optional<Operation>(), errorFactory(ErrorCode::ErrNeedRelationalOperator));
             TokenType relation = token->GetType();
             operation = if_jmp_map.find(relation)->second;
 
             // RHS
-            res = parseExpression(&function);
+            res = parseExpression(function._code);
             if (res.second.has_value())
                 return std::make_pair(std::optional<Operation>(), res.second.value());
 
             // CODE
-            auto index = function._instructions.size();
-            function._instructions.emplace_back(Instruction(index, Operation::ICMP));
+            function._code.Emit(Operation::ICMP);
             return std::make_pair(std::make_optional<Operation>(operation), std::optional<ExpresserError>());
         }
     }
@@ -935,110 +815,82 @@ namespace expresser {
         //<loop-statement> ::=
         //    'while' '(' <condition> ')' <statement>
         //   |'do' <statement> 'while' '(' <condition> ')' ';'   --   拓展C0，`do...while`
-        // break和continue
-        int32_t continue_index, break_index;
-        // 循环嵌套，保存上一个循环的跳转信息
-        std::vector<std::pair<int32_t, std::string>> prev_loop;
-        prev_loop.assign(function._loop_jumps.begin(), function._loop_jumps.end());
-        // 清空之前的跳转信息
-        function._loop_jumps.clear();
+        auto &code = function._code;
+        // break和continue的目标，循环嵌套时内层在栈顶
+        LoopLabels loop{code.NewLabel(), code.NewLabel()};
         auto token = nextToken();
-        if (token->GetStringValue() == "do") {
+        if (token->IsKeyword(Keyword::DO)) {
             // do...while
-            // | --------------- |
-            // |      nop-1      | -> 用于正常循环和continue
+            // | --------------- | -> body
             // | statement-block |
-            // | --------------- |
+            // | --------------- | -> continue
             // |       lhs       |
             // |       rhs       |
             // |       cmp       |
-            // |    jmp->nop-1   | -> 条件符合时跳转
-            // |      nop-2      | -> 用于break跳出
-            // | --------------- |
-            auto nop_index = function._instructions.size();
-            function._instructions.emplace_back(Instruction(nop_index, Operation::NOP));
+            // |    jmp->body    | -> 条件符合时跳转
+            // | --------------- | -> break
+            auto body_label = code.NewLabel();
+            code.Bind(body_label);
+            function._loops.push_back(loop);
             auto err = parseStatement(function);
             if (err.second.has_value())
                 return err.second.value();
+            function._loops.pop_back();
+            code.Bind(loop._continue);
             token = nextToken();
-            if (!token.has_value() || token->GetStringValue() != "while")
+            if (token == nullptr || !token->IsKeyword(Keyword::WHILE))
                 return errorFactory(ErrorCode::ErrNeedWhileInDoWhile);
             token = nextToken();
-            if (!token.has_value() || token->GetType() != LEFTBRACKET)
+            if (token == nullptr || token->GetType() != LEFTBRACKET)
                 return errorFactory(ErrorCode::ErrMissingBracket);
             auto res = parseCondition(function);
             if (res.second.has_value())
                 return res.second.value();
             auto operation = res.first.value();
             token = nextToken();
-            if (!token.has_value() || token->GetType() != RIGHTBRACKET)
+            if (token == nullptr || token->GetType() != RIGHTBRACKET)
                 return errorFactory(ErrorCode::ErrMissingBracket);
             token = nextToken();
-            if (!token.has_value() || token->GetType() != SEMICOLON)
+            if (token == nullptr || token->GetType() != SEMICOLON)
                 return errorFactory(ErrorCode::ErrNeedSemicolon);
             // 返回的是条件条件不符合时的跳转命令
             // 再反转一次
             operation = reverse_map.find(operation)->second;
-            auto index = function._instructions.size();
-            function._instructions.emplace_back(Instruction(index, operation, 2, nop_index));
-            function._instructions.emplace_back(Instruction(index + 1, Operation::NOP));
-            continue_index = nop_index;
-            break_index = index + 1;
-        } else if (token->GetStringValue() == "while") {
+            code.EmitJump(operation, body_label);
+            code.Bind(loop._break);
+        } else if (token->IsKeyword(Keyword::WHILE)) {
             // while
-            // | --------------- |
-            // |       nop-1     | -> 用于正常循环和continue
+            // | --------------- | -> continue
             // |       lhs       |
             // |       rhs       |
             // |       cmp       |
-            // |  jmp-1->nop-3   | -> 条件不符合时跳转
+            // |  jmp-1->break   | -> 条件不符合时跳转
             // | --------------- |
             // | statement-block |
-            // |  jmp-2->nop-1   | -> 无条件跳转
-            // | --------------- |
-            // |      nop-3      | -> 用于跳出和break
-            // | --------------- |
+            // | jmp-2->continue | -> 无条件跳转
+            // | --------------- | -> break
             token = nextToken();
-            if (!token.has_value() || token->GetType() != LEFTBRACKET)
+            if (token == nullptr || token->GetType() != LEFTBRACKET)
                 return errorFactory(ErrorCode::ErrMissingBracket);
-            auto nop1_index = function._instructions.size();
-            function._instructions.emplace_back(Instruction(nop1_index, Operation::NOP));
+            code.Bind(loop._continue);
             auto res = parseCondition(function);
             if (res.second.has_value())
                 return res.second.value();
             auto operation = res.first.value();
             token = nextToken();
-            if (!token.has_value() || token->GetType() != RIGHTBRACKET)
+            if (token == nullptr || token->GetType() != RIGHTBRACKET)
                 return errorFactory(ErrorCode::ErrMissingBracket);
-            auto nop2_index = function._instructions.size();
-            function._instructions.emplace_back(Instruction(nop2_index, Operation::NOP));
+            code.EmitJump(operation, loop._break);
+            function._loops.push_back(loop);
             auto err = parseStatement(function);
             if (err.second.has_value())
                 return err.second.value();
-            auto index = function._instructions.size();
-            function._instructions.emplace_back(Instruction(index, Operation::JMP, 2, nop1_index));
-            function._instructions.emplace_back(Instruction(index + 1, Operation::NOP));
-            auto nop3_index = index + 1;
-            // 修改跳转地址
-            function._instructions[nop2_index] = Instruction(nop2_index, operation, 2, nop3_index);
-            continue_index = nop1_index;
-            break_index = nop3_index;
+            function._loops.pop_back();
+            code.EmitJump(Operation::JMP, loop._continue);
+            code.Bind(loop._break);
         } else {
             return errorFactory(ErrorCode::ErrInvalidLoop);
         }
-        // 处理内部break和continue
-        for (const auto &jump:function._loop_jumps) {
-            if (jump.second == "break")
-                function._instructions[jump.first] = Instruction(jump.first, Operation::JMP, 2, break_index);
-            else if (jump.second == "continue")
-                function._instructions[jump.first] = Instruction(jump.first, Operation::JMP, 2, continue_index);
-            else
-                return errorFactory(ErrorCode::ErrInvalidJump);
-        }
-        // 清空跳转信息
-        function._loop_jumps.clear();
-        // 恢复上一个循环的跳转信息
-        function._loop_jumps.assign(prev_loop.begin(), prev_loop.end());
         return {};
     }
 
@@ -1051,34 +903,34 @@ namespace expresser {
         //    'return' [<expression>] ';'
         // 先跳过'return'
         auto token = nextToken();
-        if (token->GetStringValue() == "return") {
+        if (token->IsKeyword(Keyword::RETURN)) {
             auto return_type = function._return_type;
             token = nextToken();
-            if (!token.has_value())
+            if (token == nullptr)
                 return errorFactory(ErrorCode::ErrEOF);
             if (return_type == VOID) {
                 if (token->GetType() != SEMICOLON)
                     return errorFactory(ErrorCode::ErrReturnInVoidFunction);
-                auto index = function._instructions.size();
-                function._instructions.emplace_back(Instruction(index, Operation::RET));
+                function._code.Emit(Operation::RET);
                 return {};
             }
             rollback();
-            auto res = parseExpression(&function);
+            auto res = parseExpression(function._code);
             if (res.second.has_value())
                 return res.second.value();
-            auto index = function._instructions.size();
-            function._instructions.emplace_back(Instruction(index, Operation::IRET));
-        } else if (token->GetStringValue() == "break" || token->GetStringValue() == "continue") {
-            auto index = function._instructions.size();
-            function._instructions.emplace_back(Instruction(index, Operation::NOP));
-            function._loop_jumps.emplace_back(std::make_pair(index, token->GetStringValue()));
+            function._code.Emit(Operation::IRET);
+        } else if (token->IsKeyword(Keyword::BREAK) || token->IsKeyword(Keyword::CONTINUE)) {
+            // 循环外的break和continue
+            if (function._loops.empty())
+                return errorFactory(ErrorCode::ErrInvalidJump);
+            const auto &loop = function._loops.back();
+            function._code.EmitJump(Operation::JMP, token->IsKeyword(Keyword::BREAK) ? loop._break : loop._continue);
         } else {
             return errorFactory(ErrorCode::ErrInvalidStatement);
         }
         // ;
         token = nextToken();
-        if (!token.has_value() || token->GetType() != SEMICOLON)
+        if (token == nullptr || token->GetType() != SEMICOLON)
             return errorFactory(ErrorCode::ErrNeedSemicolon);
         return {};
     }
@@ -1090,7 +942,7 @@ namespace expresser {
         nextToken();
         // '('
         auto token = nextToken();
-        if (!token.has_value() || token->GetType() != LEFTBRACKET)
+        if (token == nullptr || token->GetType() != LEFTBRACKET)
             return errorFactory(ErrorCode::ErrMissingBracket);
         // [<printable-list>]
         auto err = parsePrintableList(function);
@@ -1098,15 +950,14 @@ namespace expresser {
             return err.value();
         // ')'
         token = nextToken();
-        if (!token.has_value() || token->GetType() != RIGHTBRACKET)
+        if (token == nullptr || token->GetType() != RIGHTBRACKET)
             return errorFactory(ErrorCode::ErrMissingBracket);
         // ';'
         token = nextToken();
-        if (!token.has_value() || token->GetType() != SEMICOLON)
+        if (token == nullptr || token->GetType() != SEMICOLON)
             return errorFactory(ErrorCode::ErrNeedSemicolon);
         // 追加换行
-        auto index = function._instructions.size();
-        function._instructions.emplace_back(Instruction(index, Operation::PRINTL));
+        function._code.Emit(Operation::PRINTL);
         return {};
     }
 
@@ -1115,52 +966,39 @@ namespace expresser {
         //    <printable> {',' <printable>}
         //<printable> ::=
         //    <expression> | <string-literal> | <char-literal>   --   拓展C0，字面量打印
-        std::optional<Token> token;
+        const Token *token;
         for (;;) {
             token = nextToken();
-            if (!token.has_value())
+            if (token == nullptr)
                 return errorFactory(ErrorCode::ErrInvalidPrint);
             if (token->GetType() == RIGHTBRACKET) {
                 rollback();
                 break;
             } else if (token->GetType() == COMMA) {
                 // 追加空格
-                auto index = function._instructions.size();
-                function._instructions.emplace_back(Instruction(index, BIPUSH, 1, 32));
-                function._instructions.emplace_back(Instruction(index + 1, CPRINT));
+                function._code.Emit(BIPUSH, 32);
+                function._code.Emit(CPRINT);
                 continue;
             } else if (token->GetType() == CHARLITERAL) {
-                auto index = function._instructions.size();
-                function._instructions.emplace_back(
-                        Instruction(index, Operation::IPUSH, 4, std::any_cast<int32_t>(token->GetValue())));
-                function._instructions.emplace_back(Instruction(index + 1, Operation::CPRINT));
+                function._code.Emit(Operation::IPUSH, token->GetIntValue());
+                function._code.Emit(Operation::CPRINT);
             } else if (token->GetType() == STRINGLITERAL) {
-                int32_t const_index;
-                auto it = _global_constants_index.find(token->GetStringValue());
-                if (it == _global_constants_index.end()) {
-                    const_index = _global_constants.size();
-                    _global_constants.emplace_back(Constant(const_index, 'S', token->GetStringValue()));
-                    _global_constants_index.insert({token->GetStringValue(), const_index});
-                } else {
-                    const_index = it->second;
-                }
-                auto index = function._instructions.size();
-                function._instructions.emplace_back(Instruction(index, Operation::LOADC, 2, const_index));
-                function._instructions.emplace_back(Instruction(index + 1, Operation::SPRINT));
+                auto const_index = addStringConstant(token->GetSymbol());
+                function._code.Emit(Operation::LOADC, const_index);
+                function._code.Emit(Operation::SPRINT);
             } else {
                 rollback();
-                auto res = parseExpression(&function);
+                auto res = parseExpression(function._code);
                 if (res.second.has_value())
                     return res.second.value();
                 // 根据结果类型调用iprint/cprint
                 if (!res.first.has_value())
                     return errorFactory(ErrorCode::ErrInvalidVariableType);
                 auto type = res.first.value();
-                auto index = function._instructions.size();
                 if (type == CHARLITERAL)
-                    function._instructions.emplace_back(Instruction(index, Operation::CPRINT));
+                    function._code.Emit(Operation::CPRINT);
                 else if (type == INTEGER)
-                    function._instructions.emplace_back(Instruction(index, Operation::IPRINT));
+                    function._code.Emit(Operation::IPRINT);
                 else
                     return errorFactory(ErrorCode::ErrInvalidPrint);
             }
@@ -1171,68 +1009,47 @@ namespace expresser {
     std::optional<ExpresserError> Parser::parseScanStatement(Function &function) {
         //<scan-statement> ::=
         //    'scan' '(' <identifier> ')' ';'
-        int32_t index, var_index, level;
+        int32_t var_index, level;
         TokenType type;
         // 跳过'scan'
         nextToken();
         // '('
         auto token = nextToken();
-        if (!token.has_value() || token->GetType() != LEFTBRACKET)
+        if (token == nullptr || token->GetType() != LEFTBRACKET)
             return errorFactory(ErrorCode::ErrMissingBracket);
         // <identifier>
         token = nextToken();
-        auto function_name = std::get<std::string>(_global_constants[function._name_index]._value);
-        if (!token.has_value())
+        if (token == nullptr)
             return errorFactory(ErrorCode::ErrInvalidScan);
-        auto identifier = token->GetStringValue();
-        if (isConstant(function, identifier))
-            return errorFactory(ErrorCode::ErrAssignToConstant);
-        if (isLocalVariable(function, identifier)) {
-            var_index = getIndex(function, identifier).first.value();
-            index = function._instructions.size();
-            level = 0;
-            auto res = getVariableType(function, identifier);
-            if (!res.has_value())
-                return errorFactory(ErrorCode::ErrInvalidVariableType);
-            type = res.value();
-            if (isLocalUnInitializedVariable(function, identifier)) {
-                auto it = function._local_uninitialized.find(identifier);
-                function._local_vars.insert({it->first, it->second});
-                function._local_uninitialized.erase(identifier);
-            }
-        } else if (isGlobalVariable(identifier)) {
-            var_index = getIndex(identifier).first.value();
-            index = function._instructions.size();
-            level = 1;
-            auto res = getVariableType(identifier);
-            if (!res.has_value())
-                return errorFactory(ErrorCode::ErrInvalidVariableType);
-            type = res.value();
-            if (isGlobalUnInitializedVariable(identifier)) {
-                auto it = _global_uninitialized.find(identifier);
-                _global_variables.insert({it->first, it->second});
-                _global_uninitialized.erase(identifier);
-            }
-        } else {
+        if (token->GetType() != IDENTIFIER)
+            return errorFactory(ErrorCode::ErrNeedIdentifier);
+        symbol_t identifier = token->GetSymbol();
+        auto symbol = _symbols.Resolve(identifier);
+        if (!symbol)
             return errorFactory(ErrorCode::ErrUndeclaredIdentifier);
-        }
-        function._instructions.emplace_back(Instruction(index, Operation::LOADA, 2, level, 4, var_index));
+        if (symbol->_is_const)
+            return errorFactory(ErrorCode::ErrAssignToConstant);
+        var_index = symbol->_slot;
+        level = symbol._level;
+        type = symbol->_type;
+        symbol->_initialized = true;
+        function._code.Emit(Operation::LOADA, level, var_index);
         // ')'
         token = nextToken();
-        if (!token.has_value() || token->GetType() != RIGHTBRACKET)
+        if (token == nullptr || token->GetType() != RIGHTBRACKET)
             return errorFactory(ErrorCode::ErrMissingBracket);
         // ';'
         token = nextToken();
-        if (!token.has_value() || token->GetType() != SEMICOLON)
+        if (token == nullptr || token->GetType() != SEMICOLON)
             return errorFactory(ErrorCode::ErrNeedSemicolon);
 
         if (type == CHARLITERAL)
-            function._instructions.emplace_back(Instruction(index + 1, Operation::CSCAN));
+            function._code.Emit(Operation::CSCAN);
         else if (type == INTEGER)
-            function._instructions.emplace_back(Instruction(index + 1, Operation::ISCAN));
+            function._code.Emit(Operation::ISCAN);
         else
             return errorFactory(ErrorCode::ErrInvalidVariableType);
-        function._instructions.emplace_back(Instruction(index + 2, Operation::ISTORE));
+        function._code.Emit(Operation::ISTORE);
         return {};
     }
 
@@ -1241,386 +1058,338 @@ namespace expresser {
         //<assignment-expression> ::=
         //    <identifier><assignment-operator><expression>
         // 如果类型是char，则隐式转换
-        auto function_name = std::get<std::string>(_global_constants[function._name_index]._value);
         auto token = nextToken();
-        auto var_name = token->GetStringValue();
+        auto var_name = token->GetSymbol();
         TokenType var_type;
 
-        if (isConstant(function, var_name))
-            return errorFactory(ErrorCode::ErrAssignToConstant);
-
-        if (isLocalVariable(function, var_name)) {
-            var_type = getVariableType(function, var_name).value();
-            auto index = function._instructions.size();
-            auto var_index = getIndex(function, var_name).first.value();
-            function._instructions.emplace_back(Instruction(index, Operation::LOADA, 2, 0, 4, var_index));
-            // 移出未初始化区
-            if (isLocalUnInitializedVariable(function, var_name)) {
-                auto it = function._local_uninitialized.find(var_name);
-                function._local_vars.insert({it->first, it->second});
-                function._local_uninitialized.erase(var_name);
-            }
-        } else if (isGlobalVariable(var_name)) {
-            var_type = getVariableType(var_name).value();
-            auto index = function._instructions.size();
-            auto var_index = getIndex(var_name).first.value();
-            function._instructions.emplace_back(Instruction(index, Operation::LOADA, 2, 1, 4, var_index));
-            // 移出未初始化区
-            if (isGlobalUnInitializedVariable(var_name)) {
-                auto it = _global_uninitialized.find(var_name);
-                _global_variables.insert({it->first, it->second});
-                _global_uninitialized.erase(var_name);
-            }
-        } else {
+        auto symbol = _symbols.Resolve(var_name);
+        if (!symbol)
             return errorFactory(ErrorCode::ErrUndeclaredIdentifier);
+        if (symbol->_is_const)
+            return errorFactory(ErrorCode::ErrAssignToConstant);
+        var_type = symbol->_type;
+        {
+            // LOADA取地址
+            function._code.Emit(Operation::LOADA, symbol._level, symbol->_slot);
         }
+        // 标记为已初始化
+        symbol->_initialized = true;
 
         token = nextToken();
-        if (!token.has_value() || token->GetType() != ASSIGN)
+        if (token == nullptr || token->GetType() != ASSIGN)
             return errorFactory(ErrorCode::ErrNeedAssignSymbol);
 
-        auto res = parseExpression(&function);
+        auto res = parseExpression(function._code);
         if (res.second.has_value())
             return res.second.value();
         auto res_type = res.first.value();
         if (var_type == CHARLITERAL && res_type == INTEGER) {
-            auto index = function._instructions.size();
-            function._instructions.emplace_back(Instruction(index, Operation::I2C));
+            function._code.Emit(Operation::I2C);
         }
 
         token = nextToken();
-        if (!token.has_value() || token->GetType() != SEMICOLON)
+        if (token == nullptr || token->GetType() != SEMICOLON)
             return errorFactory(ErrorCode::ErrNeedSemicolon);
-
-        auto index = function._instructions.size();
-        function._instructions.emplace_back(Instruction(index, Operation::ISTORE));
+        function._code.Emit(Operation::ISTORE);
 
         return {};
     }
 
-    std::pair<std::optional<TokenType>, std::optional<ExpresserError>> Parser::parseExpression(Function *function) {
+    std::pair<std::optional<TokenType>, std::optional<ExpresserError>> Parser::parseExpression(CodeSink &code) {
         //<expression> ::=
         //    <additive-expression>
         //<additive-expression> ::=
         //     <multiplicative-expression>{<additive-operator><multiplicative-expression>}
-        bool has_rhs = false;
-        TokenType lhs_type, rhs_type, return_type;
-        auto res = parseMultiplicativeExpression(function);
-        if (res.second.has_value())
-            return std::make_pair(std::optional<TokenType>(), res.second.value());
-        lhs_type = res.first.value();
-
-        for (;;) {
-            auto seek = seekToken(1);
-            if (seek.has_value() && (seek->GetType() == PLUS || seek->GetType() == MINUS)) {
-                // 跳过
-                nextToken();
-                Operation operation;
-                operation = seek->GetType() == PLUS ? Operation::IADD : Operation::ISUB;
-
-                res = parseMultiplicativeExpression(function);
-                if (res.second.has_value())
-                    return std::make_pair(std::optional<TokenType>(), res.second.value());
-                rhs_type = res.first.value();
-                has_rhs = true;
-
-                std::vector<Instruction> *_instruction_vector;
-                if (function != nullptr)
-                    _instruction_vector = &function->_instructions;
-                else
-                    _instruction_vector = &_start_instruments;
-                auto index = _instruction_vector->size();
-                _instruction_vector->emplace_back(Instruction(index, operation));
-            } else {
-                break;
-            }
-        }
-        if (!has_rhs)
-            return_type = lhs_type;
-        else {
-            if (lhs_type == rhs_type)
-                return_type = lhs_type;
-            else
-                return_type = INTEGER;
-        }
-        return std::make_pair(return_type, std::optional<ExpresserError>());
-    }
-
-    std::pair<std::optional<TokenType>, std::optional<ExpresserError>> Parser::parseMultiplicativeExpression(Function *function) {
-        // 拓展C0，类型转换
         //<multiplicative-expression> ::=
         //     <cast-expression>{<multiplicative-operator><cast-expression>}
-        bool has_rhs = false;
-        TokenType lhs_type, rhs_type, return_type;
-        auto res = parseCastExpression(function);
-        if (res.second.has_value())
-            return std::make_pair(std::optional<TokenType>(), res.second.value());
-        lhs_type = res.first.value();
-
-        for (;;) {
-            auto seek = seekToken(1);
-            if (seek.has_value() && (seek->GetType() == MULTIPLE || seek->GetType() == DIVIDE)) {
-                // 跳过
-                nextToken();
-                Operation operation;
-                operation = seek->GetType() == MULTIPLE ? Operation::IMUL : Operation::IDIV;
-
-                res = parseCastExpression(function);
-                if (res.second.has_value())
-                    return std::make_pair(std::optional<TokenType>(), res.second.value());
-                rhs_type = res.first.value();
-                has_rhs = true;
-
-                std::vector<Instruction> *_instruction_vector;
-                if (function != nullptr)
-                    _instruction_vector = &function->_instructions;
-                else
-                    _instruction_vector = &_start_instruments;
-                auto index = _instruction_vector->size();
-                _instruction_vector->emplace_back(Instruction(index, operation));
-            } else {
-                break;
-            }
-        }
-        if (!has_rhs)
-            return_type = lhs_type;
-        else {
-            if (lhs_type == rhs_type)
-                return_type = lhs_type;
-            else
-                return_type = INTEGER;
-        }
-        return std::make_pair(return_type, std::optional<ExpresserError>());
-    }
-
-    std::pair<std::optional<TokenType>, std::optional<ExpresserError>>
-    Parser::parseUnaryExpression(Function *function) {
+        //<cast-expression> ::=
+        //    {'('<type-specifier>')'}<unary-expression>     --   拓展C0，类型转换
         //<unary-expression> ::=
         //    [<unary-operator>]<primary-expression>
-        TokenType return_type;
-        bool reverse = false;
-        auto token = nextToken();
-        if (!token.has_value())
-            return std::make_pair(std::optional<TokenType>(), errorFactory(ErrorCode::ErrIncompleteExpression));
-        if (token->GetType() == PLUS)
-            reverse = false;
-        else if (token->GetType() == MINUS)
-            reverse = true;
-        else
-            rollback();
-
-        auto res = parsePrimaryExpression(function);
-        if (res.second.has_value())
-            return std::make_pair(std::optional<TokenType>(), res.second.value());
-        return_type = res.first.value();
-
-        if (reverse) {
-            std::vector<Instruction> *_instruction_vector;
-            if (function != nullptr)
-                _instruction_vector = &function->_instructions;
-            else
-                _instruction_vector = &_start_instruments;
-            auto index = _instruction_vector->size();
-            _instruction_vector->emplace_back(Instruction(index, Operation::INEG));
-        }
-        return std::make_pair(return_type, std::optional<ExpresserError>());
-    }
-
-    std::pair<std::optional<TokenType>, std::optional<ExpresserError>>
-    Parser::parsePrimaryExpression(Function *function) {
         //<primary-expression> ::=
         //     '('<expression>')'
         //    |<identifier>
         //    |<integer-literal>
         //    |<function-call>
         //    |<char-literal>   --   拓展C0，char
-        auto token = nextToken();
-        TokenType return_type;
-        if (!token.has_value())
-            return std::make_pair(std::optional<TokenType>(), errorFactory(ErrorCode::ErrIncompleteExpression));
-        switch (token->GetType()) {
-            case LEFTBRACKET: {
-                auto res = parseExpression(function);
-                if (res.second.has_value())
-                    return std::make_pair(std::optional<TokenType>(), res.second.value());
-                return_type = res.first.value();
-                // nmd,忘记解析右括号了
-                token = nextToken();
-                if (!token.has_value() || token->GetType() != RIGHTBRACKET)
-                    return std::make_pair(std::optional<TokenType>(), errorFactory(ErrorCode::ErrMissingBracket));
-                break;
-            }
-            case CHARLITERAL:
-            case INTEGER: {
-                auto value = std::any_cast<int32_t>(token->GetValue());
-                std::vector<Instruction> *_instruction_vector;
-                if (function != nullptr)
-                    _instruction_vector = &function->_instructions;
-                else
-                    _instruction_vector = &_start_instruments;
-                auto index = _instruction_vector->size();
-                _instruction_vector->emplace_back(Instruction(index, IPUSH, 4, value));
-                return_type = token->GetType();
-                break;
-            }
-            case IDENTIFIER: {
-                auto seek = seekToken(1);
-                if (!seek.has_value())
-                    return std::make_pair(std::optional<TokenType>(), errorFactory(ErrorCode::ErrIncompleteExpression));
-                if (seek->GetType() == LEFTBRACKET) {
-                    // CALL
-                    rollback();
-                    auto res = parseFunctionCall(function);
-                    if (res.second.has_value())
-                        return std::make_pair(std::optional<TokenType>(), res.second.value());
-                    return_type = res.first.value();
-                } else {
-                    // IDENTIFIER
-                    auto var_name = token->GetStringValue();
-                    int32_t var_index;
-                    if (function != nullptr) {
-                        // 函数内
-                        int32_t level;
-                        auto index = function->_instructions.size();
-                        auto function_name = std::get<std::string>(_global_constants[function->_name_index]._value);
-                        if (isUnInitialized(*function, var_name))
-                            return std::make_pair(std::optional<TokenType>(), errorFactory(ErrorCode::ErrNotInitialized));
-                        if (isLocalVariable(*function, var_name)) {
-                            if (isLocalUnInitializedVariable(*function, var_name))
-                                return std::make_pair(std::optional<TokenType>(), errorFactory(ErrorCode::ErrNotInitialized));
-                            auto res = getIndex(*function, var_name);
-                            if (res.second.has_value())
-                                return std::make_pair(std::optional<TokenType>(), res.second.value());
-                            var_index = res.first.value();
-                            level = 0;
-                            return_type = getVariableType(*function, var_name).value();
-                        } else if (isGlobalVariable(var_name)) {
-                            if (isGlobalUnInitializedVariable(var_name))
-                                return std::make_pair(std::optional<TokenType>(), errorFactory(ErrorCode::ErrNotInitialized));
-                            auto res = getIndex(var_name);
-                            if (res.second.has_value())
-                                return std::make_pair(std::optional<TokenType>(), res.second.value());
-                            var_index = res.first.value();
-                            level = 1;
-                            return_type = getVariableType(var_name).value();
-                        } else
-                            return std::make_pair(std::optional<TokenType>(), errorFactory(ErrorCode::ErrUndeclaredIdentifier));
-                        function->_instructions.emplace_back(Instruction(index, LOADA, 2, level, 4, var_index));
-                        function->_instructions.emplace_back(Instruction(index + 1, ILOAD));
-                    } else {
-                        // start段
-                        auto index = _start_instruments.size();
-                        if (isGlobalUnInitializedVariable(var_name))
-                            return std::make_pair(std::optional<TokenType>(),
-                                                  errorFactory(ErrorCode::ErrNotInitialized));
-                        auto res = getIndex(var_name);
-                        if (res.second.has_value())
-                            return std::make_pair(std::optional<TokenType>(), res.second.value());
-                        var_index = res.first.value();
-                        _start_instruments.emplace_back(Instruction(index, LOADA, 2, 0, 4, var_index));
-                        _start_instruments.emplace_back(Instruction(index + 1, ILOAD));
-                        return_type = getVariableType(var_name).value();
-                    }
-                }
-                break;
-            }
-            default:
-                return std::make_pair(std::optional<TokenType>(), errorFactory(ErrorCode::ErrInvalidExpression));
-        }
-        return std::make_pair(return_type, std::optional<ExpresserError>());
+        _expression_frames.clear();
+        _expression_frames.emplace_back(ExpressionFrame::OUTERMOST);
+        return evaluateExpression(code);
     }
 
-    std::pair<std::optional<TokenType>, std::optional<ExpresserError>> Parser::parseFunctionCall(Function *function) {
+    std::pair<std::optional<TokenType>, std::optional<ExpresserError>> Parser::parseFunctionCall(CodeSink &code) {
         //<function-call> ::=
         //    <identifier> '(' [<expression-list>] ')'
         //<expression-list> ::=
         //    <expression>{','<expression>}
+        _expression_frames.clear();
+        auto err = beginFunctionCall(code);
+        if (err.has_value())
+            return std::make_pair(std::optional<TokenType>(), err.value());
+        return evaluateExpression(code);
+    }
+
+    void Parser::emitConstant(CodeSink &code, int32_t value) {
+        // bipush的操作数只有1字节
+        if (value >= 0 && value <= INT8_MAX)
+            code.Emit(BIPUSH, value);
+        else
+            code.Emit(IPUSH, value);
+    }
+
+    std::optional<ExpresserError> Parser::beginFunctionCall(CodeSink &code) {
         // 无法在全局区调用函数
-        TokenType return_type = VOID;
-        if (function == nullptr)
-            return std::make_pair(std::optional<TokenType>(), errorFactory(ErrorCode::ErrCallFunctionInStartSection));
+        if (code.IsStartSection())
+            return errorFactory(ErrorCode::ErrCallFunctionInStartSection);
         auto token = nextToken();
-        if (!token.has_value() || token->GetType() != IDENTIFIER)
-            return std::make_pair(std::optional<TokenType>(), errorFactory(ErrorCode::ErrNeedFunctionName));
-        auto function_name = token->GetStringValue();
+        if (token == nullptr || token->GetType() != IDENTIFIER)
+            return errorFactory(ErrorCode::ErrNeedFunctionName);
+        auto function_name = token->GetSymbol();
         token = nextToken();
-        if (!token.has_value() || token->GetType() != LEFTBRACKET)
-            return std::make_pair(std::optional<TokenType>(), errorFactory(ErrorCode::ErrMissingBracket));
-        for (;;) {
-            token = nextToken();
-            if (!token.has_value())
-                return std::make_pair(std::optional<TokenType>(), errorFactory(ErrorCode::ErrInvalidFunctionCall));
-            if (token->GetType() == COMMA)
-                continue;
-            else if (token->GetType() == RIGHTBRACKET)
-                break;
-            else {
-                rollback();
-                auto res = parseExpression(function);
-                if (res.second.has_value())
-                    return std::make_pair(std::optional<TokenType>(), res.second.value());
-                return_type = res.first.value();
-            }
-        }
-        auto index = function->_instructions.size();
-        auto func_index = _functions[function_name]._index;
-        function->_instructions.emplace_back(Instruction(index, Operation::CALL, 2, func_index));
-        return std::make_pair(return_type, std::optional<ExpresserError>());
+        if (token == nullptr || token->GetType() != LEFTBRACKET)
+            return errorFactory(ErrorCode::ErrMissingBracket);
+        auto &frame = _expression_frames.emplace_back(ExpressionFrame::CALL);
+        frame._function_name = function_name;
+        return {};
     }
 
-    std::pair<std::optional<TokenType>, std::optional<ExpresserError>> Parser::parseCastExpression(Function *function) {
-        // 拓展C0，类型转换
-        //<cast-expression> ::=
-        //    {'('<type-specifier>')'}<unary-expression>
-        bool cast = false;
-        TokenType return_type;
-        auto seek1 = seekToken(1), seek2 = seekToken(2), seek3 = seekToken(3);
-        if (seek1.has_value() && seek1->GetType() == LEFTBRACKET &&
-            seek2.has_value() && seek2->GetType() == RESERVED &&
-            seek3.has_value() && seek3->GetType() == RIGHTBRACKET) {
-            // CAST
-            auto cast_type = stringTypeToTokenType(seek2->GetStringValue());
-            // int不用转，因为内部存储方式就是int
-            // char只在print时需要强转
-            // double不支持
-            if (!cast_type.has_value())
-                return std::make_pair(std::optional<TokenType>(), errorFactory(ErrorCode::ErrInvalidCast));
-            if (cast_type.value() == VOID)
-                return std::make_pair(std::optional<TokenType>(), errorFactory(ErrorCode::ErrCastToVoid));
-            // SKIP
-            nextToken();
-            nextToken();
-            nextToken();
-            cast = true;
-            return_type = cast_type.value();
-        }
-        // UNARY
-        auto res = parseUnaryExpression(function);
-        if (res.second.has_value())
-            return std::make_pair(std::optional<TokenType>(), res.second.value());
-        if (!cast)
-            return_type = res.first.value();
-        if (cast && res.first.value() == INTEGER && return_type == CHARLITERAL) {
-            auto index = function->_instructions.size();
-            function->_instructions.emplace_back(Instruction(index, I2C));
+    std::pair<std::optional<TokenType>, std::optional<ExpresserError>> Parser::evaluateExpression(CodeSink &code) {
+        // 括号、函数调用和实参都在_expression_frames上展开，不递归
+        // OPERAND：读一个<cast-expression>直到<primary-expression>
+        // ARGUMENTS：在实参列表中，读','、')'或下一个实参
+        // VALUE：得到一个操作数，按优先级归约
+        enum { OPERAND, ARGUMENTS, VALUE } state =
+                _expression_frames.back()._kind == ExpressionFrame::CALL ? ARGUMENTS : OPERAND;
+        // VALUE状态下操作数的类型
+        TokenType value = VOID;
+        // 操作数是编译期常量时为其值，此时它恰好是代码末尾的一条push
+        std::optional<int32_t> constant;
+        for (;;) {
+            switch (state) {
+                case ARGUMENTS: {
+                    auto token = nextToken();
+                    if (token == nullptr)
+                        return std::make_pair(std::optional<TokenType>(), errorFactory(ErrorCode::ErrInvalidFunctionCall));
+                    if (token->GetType() == COMMA)
+                        break;
+                    if (token->GetType() != RIGHTBRACKET) {
+                        rollback();
+                        _expression_frames.emplace_back(ExpressionFrame::ARGUMENT);
+                        state = OPERAND;
+                        break;
+                    }
+                    // 调用的类型是最后一个实参的类型，没有实参时为void
+                    auto &frame = _expression_frames.back();
+                    auto func_index = _functions[frame._function_name]._index;
+                    code.Emit(Operation::CALL, func_index);
+                    value = frame._call_type;
+                    constant.reset();
+                    _expression_frames.pop_back();
+                    // 作为语句的函数调用
+                    if (_expression_frames.empty())
+                        return std::make_pair(value, std::optional<ExpresserError>());
+                    state = VALUE;
+                    break;
+                }
+                case OPERAND: {
+                    auto &frame = _expression_frames.back();
+                    frame._negate = false;
+                    frame._cast = false;
+                    // 类型转换
+                    auto seek1 = seekToken(1), seek2 = seekToken(2), seek3 = seekToken(3);
+                    if (seek1 != nullptr && seek1->GetType() == LEFTBRACKET &&
+                        seek2 != nullptr && seek2->GetType() == RESERVED &&
+                        seek3 != nullptr && seek3->GetType() == RIGHTBRACKET) {
+                        auto cast_type = keywordToTokenType(seek2->GetKeyword());
+                        // int不用转，因为内部存储方式就是int
+                        // char只在print时需要强转
+                        // double不支持
+                        if (!cast_type.has_value())
+                            return std::make_pair(std::optional<TokenType>(), errorFactory(ErrorCode::ErrInvalidCast));
+                        if (cast_type.value() == VOID)
+                            return std::make_pair(std::optional<TokenType>(), errorFactory(ErrorCode::ErrCastToVoid));
+                        nextToken();
+                        nextToken();
+                        nextToken();
+                        frame._cast = true;
+                        frame._cast_type = cast_type.value();
+                    }
+                    // 一元运算符
+                    auto token = nextToken();
+                    if (token == nullptr)
+                        return std::make_pair(std::optional<TokenType>(), errorFactory(ErrorCode::ErrIncompleteExpression));
+                    if (token->GetType() == MINUS)
+                        frame._negate = true;
+                    else if (token->GetType() != PLUS)
+                        rollback();
+                    // <primary-expression>
+                    token = nextToken();
+                    if (token == nullptr)
+                        return std::make_pair(std::optional<TokenType>(), errorFactory(ErrorCode::ErrIncompleteExpression));
+                    switch (token->GetType()) {
+                        case LEFTBRACKET:
+                            // 括号内是新的一帧，frame此后失效
+                            _expression_frames.emplace_back(ExpressionFrame::PARENTHESIS);
+                            break;
+                        case CHARLITERAL:
+                        case INTEGER:
+                            emitConstant(code, token->GetIntValue());
+                            constant = token->GetIntValue();
+                            value = token->GetType();
+                            state = VALUE;
+                            break;
+                        case IDENTIFIER: {
+                            auto seek = seekToken(1);
+                            if (seek == nullptr)
+                                return std::make_pair(std::optional<TokenType>(), errorFactory(ErrorCode::ErrIncompleteExpression));
+                            if (seek->GetType() == LEFTBRACKET) {
+                                // CALL
+                                rollback();
+                                auto err = beginFunctionCall(code);
+                                if (err.has_value())
+                                    return std::make_pair(std::optional<TokenType>(), err.value());
+                                state = ARGUMENTS;
+                                break;
+                            }
+                            // IDENTIFIER
+                            auto var_name = token->GetSymbol();
+                            // 函数内先找局部再找全局，start段只有全局
+                            auto symbol = _symbols.Resolve(var_name);
+                            // 函数名不能作为变量使用
+                            if (!symbol || symbol->_is_function)
+                                return std::make_pair(std::optional<TokenType>(), errorFactory(ErrorCode::ErrUndeclaredIdentifier));
+                            if (!symbol->_initialized)
+                                return std::make_pair(std::optional<TokenType>(), errorFactory(ErrorCode::ErrNotInitialized));
+                            constant = symbol->_value;
+                            if (constant.has_value()) {
+                                emitConstant(code, constant.value());
+                            } else {
+                                code.Emit(LOADA, symbol._level, symbol->_slot);
+                                code.Emit(ILOAD);
+                            }
+                            value = symbol->_type;
+                            state = VALUE;
+                            break;
+                        }
+                        default:
+                            return std::make_pair(std::optional<TokenType>(), errorFactory(ErrorCode::ErrInvalidExpression));
+                    }
+                    break;
+                }
+                case VALUE: {
+                    auto &frame = _expression_frames.back();
+                    // 先取负，再类型转换
+                    if (frame._negate) {
+                        if (constant.has_value()) {
+                            code.PopBack();
+                            constant = static_cast<int32_t>(0u - static_cast<uint32_t>(constant.value()));
+                            emitConstant(code, constant.value());
+                        } else {
+                            code.Emit(Operation::INEG);
+                        }
+                    }
+                    if (frame._cast) {
+                        // i2c不折叠，由VM决定截断方式
+                        if (value == INTEGER && frame._cast_type == CHARLITERAL) {
+                            code.Emit(I2C);
+                            constant.reset();
+                        }
+                        value = frame._cast_type;
+                    }
+                    // 下一个二元运算符的优先级，0表示表达式到此结束
+                    auto seek = seekToken(1);
+                    uint8_t precedence = seek == nullptr ? 0 : binary_operator_table[seek->GetType()]._precedence;
+                    // 操作数交给最高一级，优先级高于下一个运算符的各级依次结束，结果交给低一级
+                    auto level = max_precedence;
+                    for (;;) {
+                        auto &group = frame._levels[level];
+                        if (group._pending != NOP) {
+                            // 两个操作数都是常量时，它们是末尾的两条push，替换为结果
+                            std::optional<int32_t> folded;
+                            if (group._constant.has_value() && constant.has_value())
+                                folded = foldBinary(group._pending, group._constant.value(), constant.value());
+                            if (folded.has_value()) {
+                                code.PopBack();
+                                code.PopBack();
+                                emitConstant(code, folded.value());
+                            } else {
+                                code.Emit(group._pending);
+                            }
+                            group._constant = folded;
+                            group._rhs = value;
+                            group._has_rhs = true;
+                            group._pending = NOP;
+                        } else {
+                            group._lhs = value;
+                            group._has_rhs = false;
+                            group._constant = constant;
+                        }
+                        if (precedence >= level)
+                            break;
+                        // 类型相同时保持，否则为int
+                        if (group._has_rhs && group._lhs != group._rhs)
+                            value = INTEGER;
+                        else
+                            value = group._lhs;
+                        constant = group._constant;
+                        if (--level == 0)
+                            break;
+                    }
+                    if (level != 0) {
+                        // 跳过运算符，等待右操作数
+                        nextToken();
+                        frame._levels[level]._pending = binary_operator_table[seek->GetType()]._operation;
+                        state = OPERAND;
+                        break;
+                    }
+                    // 这一帧结束，value为其类型
+                    switch (frame._kind) {
+                        case ExpressionFrame::OUTERMOST:
+                            _expression_value = constant;
+                            return std::make_pair(value, std::optional<ExpresserError>());
+                        case ExpressionFrame::PARENTHESIS: {
+                            auto token = nextToken();
+                            if (token == nullptr || token->GetType() != RIGHTBRACKET)
+                                return std::make_pair(std::optional<TokenType>(), errorFactory(ErrorCode::ErrMissingBracket));
+                            // 括号整体是外层的一个操作数
+                            _expression_frames.pop_back();
+                            break;
+                        }
+                        case ExpressionFrame::ARGUMENT:
+                            _expression_frames.pop_back();
+                            _expression_frames.back()._call_type = value;
+                            state = ARGUMENTS;
+                            break;
+                        default:
+                            ExceptionPrint("unexpected expression frame");
+                    }
+                    break;
+                }
+            }
         }
-        return std::make_pair(return_type, std::optional<ExpresserError>());
     }
 
     bool Parser::isVariableType(const Token &token) {
         // 传入的token._type==RESERVED
-        return isFunctionReturnType(token) && token.GetStringValue() != "void";
+        return isFunctionReturnType(token) && token.GetKeyword() != Keyword::VOID;
     }
 
     bool Parser::isFunctionReturnType(const Token &token) {
-        auto it = _function_return_type_map.find(token.GetStringValue());
-        return it != _function_return_type_map.end();
+        return keywordToTokenType(token.GetKeyword()).has_value();
     }
 
-    std::optional<TokenType> Parser::stringTypeToTokenType(const std::string &type_name) {
-        auto it = _function_return_type_map.find(type_name);
-        if (it != _function_return_type_map.end())
-            return it->second;
-        return {};
+    std::optional<TokenType> Parser::keywordToTokenType(Keyword keyword) {
+        switch (keyword) {
+            case Keyword::INT:
+                return TokenType::INTEGER;
+            case Keyword::CHAR:
+                return TokenType::CHARLITERAL;
+            case Keyword::DOUBLE:
+                return TokenType::DOUBLE;
+            case Keyword::VOID:
+                return TokenType::VOID;
+            default:
+                return {};
+        }
     }
 }
\ No newline at end of file
@@ -1,50 +1,57 @@
 #ifndef EXPRESSER_PARSER_H
 #define EXPRESSER_PARSER_H
 
+#include <memory_resource>
 #include <optional>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <variant>
 #include <vector>
 
+#include "Lexer/Interner.h"
+#include "Lexer/Lexer.h"
 #include "Lexer/Token.h"
+#include "Lexer/TokenStream.h"
+#include "Instruction/CodeSink.h"
 #include "Instruction/Instruction.h"
+#include "Parser/SymbolTable.h"
 
 namespace expresser {
     // 静态常量
     const static std::set<TokenType> _variable_type_set = {INTEGER, DOUBLE, CHARLITERAL};
-    const static std::map<std::string, TokenType> _function_return_type_map =
-            {{"int",    TokenType::INTEGER},
-             {"char",   TokenType::CHARLITERAL},
-             {"double", TokenType::DOUBLE},
-             {"void",   TokenType::VOID}};
 
     struct Constant {
         // 常量有字符串S、双浮点D、整型I三种类型
         int32_t _index;
         char _type;
-        std::variant<int32_t, double, std::string> _value;
+        // 字符串指向Interner中驻留的内容
+        std::variant<int32_t, double, std::string_view> _value;
 
         Constant() = default;
 
         template<typename T>
         Constant(int32_t index, char type, T value): _index(index), _type(type), _value(value) {}
 
-        Constant(const Constant &c) : _index(c._index), _type(c._type), _value(c._value) {};
-        std::string ToCode();
-        std::vector<uint8_t> ToBinary();
+        // 二进制格式的字节数
+        uint32_t EncodedSize() const;
+        // 写入EncodedSize()个字节，返回写入后的位置
+        uint8_t *Encode(uint8_t *out) const;
     };
 
     struct FunctionParam {
         TokenType _type;
-        std::string _value;
+        symbol_t _value;
         bool _is_const;
 
-        FunctionParam(TokenType type, std::string value, bool is_const) :
-                _type(type), _value(std::move(value)), _is_const(is_const) {}
+        FunctionParam(TokenType type, symbol_t value, bool is_const) :
+                _type(type), _value(value), _is_const(is_const) {}
+    };
 
-        FunctionParam(const FunctionParam &fp) :
-                _type(fp._type), _value(fp._value), _is_const(fp._is_const) {}
+    // 循环中break和continue的跳转目标
+    struct LoopLabels {
+        label_t _continue;
+        label_t _break;
     };
 
     struct Function {
@@ -53,91 +60,126 @@ namespace expresser {
         int32_t _params_size{};
         int32_t _level{};
         TokenType _return_type{};
-        std::vector<FunctionParam> _params;
+        std::pmr::vector<FunctionParam> _params;
 
         // 局部栈顶值，初始值为参数个数
         int32_t _local_sp{};
-        // 局部常量表
-        std::map<std::string, int32_t> _local_constants;
-        // 局部变量表（已初始化）
-        std::map<std::string, int32_t> _local_vars;
-        // 局部变量表（未初始化）
-        std::map<std::string, int32_t> _local_uninitialized;
-        std::map<std::string, TokenType> _local_type_map;
-        std::vector<Instruction> _instructions;
-        // break和continue表
-        std::vector<std::pair<int32_t, std::string>> _loop_jumps;
+        CodeSink _code;
+        // 正在解析的循环，最内层在末尾
+        std::pmr::vector<LoopLabels> _loops;
 
         // 构造函数
         Function() = default;
 
+        // 代码和循环栈与参数表从同一个memory_resource分配
         Function(int32_t index, int32_t name_index, int32_t param_size, TokenType return_type,
-                 std::vector<FunctionParam> params) :
+                 std::pmr::vector<FunctionParam> params) :
                 _index(index), _name_index(name_index), _params_size(param_size), _level(1),
-                _return_type(return_type), _params(std::move(params)), _local_sp(param_size) {}
+                _return_type(return_type), _params(std::move(params)), _local_sp(param_size),
+                _code(false, _params.get_allocator().resource()), _loops(_params.get_allocator()) {}
+
+        uint32_t EncodedSize() const;
+        uint8_t *Encode(uint8_t *out) const;
+    };
 
-        std::vector<uint8_t> ToBinary();
+    // 二元运算符的优先级层数，1为加减，2为乘除
+    constexpr uint8_t max_precedence = 2;
+
+    // 表达式解析的显式栈帧，每层括号、每个函数调用和其中每个实参各占一帧
+    // 嵌套深度只受堆内存限制，不消耗调用栈
+    struct ExpressionFrame {
+        enum Kind : uint8_t {
+            // 最外层的<expression>
+            OUTERMOST,
+            // '('<expression>')'
+            PARENTHESIS,
+            // 函数调用的实参列表
+            CALL,
+            // 一个实参
+            ARGUMENT
+        };
+
+        // 同一优先级上连续的运算
+        // 结果类型：没有右操作数时为第一个操作数的类型，否则第一个与最后一个相同时保持，不同时为int
+        struct Level {
+            TokenType _lhs;
+            TokenType _rhs;
+            bool _has_rhs;
+            // 等待右操作数的运算符，NOP表示没有
+            Operation _pending;
+            // 目前的结果是编译期常量时为其值，此时它恰好是代码末尾的一条push
+            std::optional<int32_t> _constant;
+        };
+
+        Kind _kind;
+        // 当前操作数的一元负号和类型转换
+        bool _negate;
+        bool _cast;
+        TokenType _cast_type;
+        Level _levels[max_precedence + 1];
+        // CALL：被调用的函数和最后一个实参的类型
+        symbol_t _function_name;
+        TokenType _call_type;
+
+        explicit ExpressionFrame(Kind kind) :
+                _kind(kind), _negate(false), _cast(false), _cast_type(VOID), _levels(),
+                _function_name(0), _call_type(VOID) {}
     };
 
     class Parser final {
     private:
         bool _program_end;
-        uint32_t _offset;
-        position_t _current_pos;
-        std::vector<expresser::Token> _tokens;
-        std::map<std::string, int32_t> _global_constants_index;
-        // 全局常量表（栈上）
-        std::map<std::string, int32_t> _global_stack_constants;
+        // 上一个token末尾的偏移，语法错误报告在这里
+        uint32_t _current_offset;
+        // 从Lexer按需拉取token
+        TokenStream _tokens;
+        // 与Lexer共享的字符串驻留表，符号表均以符号id为键
+        const Interner &_interner;
+        // 编译期间的数据结构都从这里分配
+        std::pmr::memory_resource *_resource;
+        // 字符串常量在常量池中的下标，函数名和print的字符串字面量共用
+        std::pmr::unordered_map<symbol_t, int32_t> _global_constants_index;
+        // 全局和函数作用域的变量、常量、函数名
+        SymbolTable _symbols;
         // 全局栈顶值
         int32_t _global_sp;
-        // 全局变量在栈中地址
-        std::map<std::string, int32_t> _global_variables;
-        // 全局未初始化变量在栈中地址
-        std::map<std::string, int32_t> _global_uninitialized;
-        std::map<std::string, TokenType> _global_type_map;
+        // 表达式解析栈，各表达式复用
+        std::pmr::vector<ExpressionFrame> _expression_frames;
+        // 上一个parseExpression的结果是编译期常量时为其值
+        std::optional<int32_t> _expression_value;
     public:
         // 全局常量表
-        std::vector<Constant> _global_constants;
+        std::pmr::vector<Constant> _global_constants;
         // .start段的代码
-        std::vector<expresser::Instruction> _start_instruments;
+        CodeSink _start_code;
         // 函数表
-        std::map<std::string, Function> _functions;
+        std::pmr::unordered_map<symbol_t, Function> _functions;
     public:
-        explicit Parser(std::vector<expresser::Token> _token_vector) :
-                _program_end(false), _offset(0), _current_pos({0, 0}), _tokens(std::move(_token_vector)),
-                _global_sp(0) {}
+        Parser(Lexer &lexer, const Interner &interner,
+               std::pmr::memory_resource *resource = std::pmr::get_default_resource()) :
+                _program_end(false), _current_offset(0), _tokens(lexer), _interner(interner), _resource(resource),
+                _global_constants_index(resource), _symbols(resource), _global_sp(0), _expression_frames(resource),
+                _global_constants(resource), _start_code(true, resource), _functions(resource) {}
 
         std::optional<ExpresserError> Parse();
+        // 按下标排列的函数，供输出
+        std::vector<const Function *> FunctionsInOrder() const;
+        // 词法错误优先于语法错误报告，需要读完剩余的输入
+        std::optional<ExpresserError> LexerError();
     private:
         // 辅助函数
-        std::optional<Token> nextToken();
-        std::optional<Token> seekToken(int32_t offset);
+        // 返回的指针指向TokenStream的缓冲区，只在随后的几个token内有效
+        const Token *nextToken();
+        const Token *seekToken(int32_t offset);
         void rollback();
-        template<typename T>
-        std::optional<ExpresserError> addGlobalConstant(const std::string &constant_name, const char type, T value);
-        std::optional<ExpresserError> addGlobalConstant(const std::string &variable_name, TokenType type);
-        std::optional<ExpresserError> addGlobalVariable(const std::string &variable_name, TokenType type);
+        int32_t addStringConstant(symbol_t value);
+        std::optional<ExpresserError> addGlobalConstant(symbol_t variable_name, TokenType type);
+        std::optional<ExpresserError> addGlobalVariable(symbol_t variable_name, TokenType type);
         std::pair<Function *, std::optional<ExpresserError>>
-        addFunction(const std::string &function_name, const TokenType &return_type, const std::vector<FunctionParam> &params);
-        std::optional<ExpresserError> addLocalConstant(Function &function, TokenType type, const std::string &constant_name);
-        std::optional<ExpresserError> addLocalVariable(Function &function, TokenType type, const std::string &variable_name);
-        std::pair<std::optional<int32_t>, std::optional<ExpresserError>> getIndex(const std::string &variable_name);
-        std::pair<std::optional<int32_t>, std::optional<ExpresserError>>
-        getIndex(Function &function, const std::string &variable_name);
-        std::pair<Function *, std::optional<ExpresserError>> getFunction(const std::string &function_name);
-        bool isGlobalVariable(const std::string &variable_name);
-        bool isGlobalInitializedVariable(const std::string &variable_name);
-        bool isGlobalUnInitializedVariable(const std::string &variable_name);
-        bool isGlobalConstant(const std::string &variable_name);
-        bool isLocalVariable(Function &function, const std::string &variable_name);
-        bool isLocalInitializedVariable(Function &function, const std::string &variable_name);
-        bool isLocalUnInitializedVariable(Function &function, const std::string &variable_name);
-        bool isLocalConstant(Function &function, const std::string &variable_name);
-        bool isInitialized(Function &function, const std::string &variable_name);
-        bool isUnInitialized(Function &function, const std::string &variable_name);
-        bool isConstant(Function &function, const std::string &variable_name);
-        std::optional<TokenType> getVariableType(const std::string &variable_name);
-        std::optional<TokenType> getVariableType(Function &function, const std::string &variable_name);
+        addFunction(symbol_t function_name, const TokenType &return_type, std::pmr::vector<FunctionParam> params);
+        std::optional<ExpresserError> addLocalConstant(Function &function, TokenType type, symbol_t constant_name);
+        std::optional<ExpresserError> addLocalVariable(Function &function, TokenType type, symbol_t variable_name);
+        std::pair<Function *, std::optional<ExpresserError>> getFunction(symbol_t function_name);
         std::optional<ExpresserError> errorFactory(ErrorCode code);
 
         // 语法制导翻译
@@ -145,12 +187,12 @@ namespace expresser {
         std::optional<ExpresserError> parseProgram();
         std::optional<ExpresserError> parseGlobalDeclarations();
         std::optional<ExpresserError> parseFunctionDefinitions();
-        std::pair<std::optional<TokenType>, std::optional<ExpresserError>> parseExpression(Function *function);
-        std::pair<std::optional<TokenType>, std::optional<ExpresserError>> parseMultiplicativeExpression(Function *function);
-        std::pair<std::optional<TokenType>, std::optional<ExpresserError>> parseUnaryExpression(Function *function);
-        std::pair<std::optional<TokenType>, std::optional<ExpresserError>> parsePrimaryExpression(Function *function);
-        std::pair<std::optional<TokenType>, std::optional<ExpresserError>> parseFunctionCall(Function *function);
-        std::optional<ExpresserError> parseParameterDeclarations(std::vector<FunctionParam> &params);
+        std::pair<std::optional<TokenType>, std::optional<ExpresserError>> parseExpression(CodeSink &code);
+        std::pair<std::optional<TokenType>, std::optional<ExpresserError>> parseFunctionCall(CodeSink &code);
+        std::optional<ExpresserError> beginFunctionCall(CodeSink &code);
+        std::pair<std::optional<TokenType>, std::optional<ExpresserError>> evaluateExpression(CodeSink &code);
+        void emitConstant(CodeSink &code, int32_t value);
+        std::optional<ExpresserError> parseParameterDeclarations(std::pmr::vector<FunctionParam> &params);
         std::optional<ExpresserError> parseFunctionDefinition();
         std::optional<ExpresserError> parseCompoundStatement(Function &function);
         std::optional<ExpresserError> parseLocalVariableDeclarations(Function &function);
@@ -164,13 +206,11 @@ namespace expresser {
         std::optional<ExpresserError> parsePrintableList(Function &function);
         std::optional<ExpresserError> parseScanStatement(Function &function);
         std::optional<ExpresserError> parseAssignmentExpression(Function &function);
-        // 拓展C0
-        std::pair<std::optional<TokenType>, std::optional<ExpresserError>> parseCastExpression(Function *function);
 
         // 静态函数
         static bool isVariableType(const Token &token);
         static bool isFunctionReturnType(const Token &token);
-        static std::optional<TokenType> stringTypeToTokenType(const std::string &type_name);
+        static std::optional<TokenType> keywordToTokenType(Keyword keyword);
     };
 }
 #endif //EXPRESSER_PARSER_H
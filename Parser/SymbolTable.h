@@ -0,0 +1,147 @@
+#ifndef EXPRESSER_SYMBOLTABLE_H
+#define EXPRESSER_SYMBOLTABLE_H
+
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <vector>
+
+#include "Types.h"
+#include "Lexer/Token.h"
+
+namespace expresser {
+    // 符号表中的一项
+    struct Symbol {
+        symbol_t _name;
+        // 栈上的slot；函数为函数名在常量池中的下标
+        int32_t _slot;
+        TokenType _type;
+        bool _is_const;
+        bool _is_function;
+        // 变量赋值后置位，常量、参数、函数声明时即为已初始化
+        bool _initialized;
+        // 初始值在编译期已知的常量，引用处直接折叠
+        std::optional<int32_t> _value;
+    };
+
+    // Resolve的结果
+    struct SymbolRef {
+        Symbol *_symbol;
+        // 当前作用域到符号所在作用域的层数，即loada的level
+        int32_t _level;
+
+        explicit operator bool() const { return _symbol != nullptr; }
+
+        Symbol *operator->() const { return _symbol; }
+    };
+
+    // 作用域嵌套的符号表，每层作用域是一张以符号id为键的开放寻址哈希表
+    // C0只有全局和函数两层作用域，函数结束时清空函数作用域，表的内存留给下一个函数复用
+    class SymbolTable final {
+    private:
+        class Scope final {
+        private:
+            static constexpr symbol_t empty = UINT32_MAX;
+            // 容量为2的幂，线性探测
+            std::pmr::vector<Symbol> _entries;
+            // 已占用的位置，用于清空
+            std::pmr::vector<uint32_t> _used;
+
+            uint32_t mask() const { return _entries.size() - 1; }
+
+            // 符号id从0开始连续分配，用乘法散列打散
+            uint32_t probeStart(symbol_t name) const { return (name * 0x9E3779B1u) & mask(); }
+
+            void grow() {
+                std::pmr::vector<Symbol> entries(_entries.size() * 2, Symbol{empty}, _entries.get_allocator());
+                std::swap(_entries, entries);
+                std::pmr::vector<uint32_t> used(_used.get_allocator());
+                std::swap(_used, used);
+                for (auto pos : used)
+                    insert(entries[pos]);
+            }
+
+            Symbol *insert(const Symbol &symbol) {
+                auto pos = probeStart(symbol._name);
+                while (_entries[pos]._name != empty)
+                    pos = (pos + 1) & mask();
+                _entries[pos] = symbol;
+                _used.push_back(pos);
+                return &_entries[pos];
+            }
+
+        public:
+            explicit Scope(std::pmr::memory_resource *resource) : _entries(16, Symbol{empty}, resource), _used(resource) {}
+
+            Symbol *Find(symbol_t name) {
+                for (auto pos = probeStart(name);; pos = (pos + 1) & mask()) {
+                    // 先判空位，name恰为empty时也不会误命中
+                    if (_entries[pos]._name == empty)
+                        return nullptr;
+                    if (_entries[pos]._name == name)
+                        return &_entries[pos];
+                }
+            }
+
+            // 调用者保证name不在表中
+            Symbol *Insert(const Symbol &symbol) {
+                // 负载不超过1/2
+                if ((_used.size() + 1) * 2 > _entries.size())
+                    grow();
+                return insert(symbol);
+            }
+
+            void Clear() {
+                for (auto pos : _used)
+                    _entries[pos]._name = empty;
+                _used.clear();
+            }
+        };
+
+        std::pmr::vector<Scope> _scopes;
+        // 当前作用域在_scopes中的下标，0为全局
+        uint32_t _depth;
+
+    public:
+        explicit SymbolTable(std::pmr::memory_resource *resource = std::pmr::get_default_resource()) :
+                _scopes(resource), _depth(0) {
+            _scopes.emplace_back(resource);
+        }
+
+        void EnterScope() {
+            if (++_depth == _scopes.size())
+                _scopes.emplace_back(_scopes.get_allocator().resource());
+        }
+
+        void LeaveScope() {
+            _scopes[_depth--].Clear();
+        }
+
+        // 在当前作用域声明，同一作用域内重复声明时返回nullptr
+        // 返回的指针在下一次声明前有效
+        Symbol *Declare(symbol_t name, int32_t slot, TokenType type, bool is_const, bool initialized,
+                        bool is_function = false) {
+            auto &scope = _scopes[_depth];
+            if (scope.Find(name) != nullptr)
+                return nullptr;
+            return scope.Insert(Symbol{name, slot, type, is_const, is_function, initialized});
+        }
+
+        // 只在当前作用域查找
+        bool IsDeclared(symbol_t name) {
+            return _scopes[_depth].Find(name) != nullptr;
+        }
+
+        // 由内向外查找
+        SymbolRef Resolve(symbol_t name) {
+            for (uint32_t depth = _depth + 1; depth-- > 0;) {
+                auto symbol = _scopes[depth].Find(name);
+                if (symbol != nullptr)
+                    return SymbolRef{symbol, static_cast<int32_t>(_depth - depth)};
+            }
+            return SymbolRef{nullptr, 0};
+        }
+    };
+}
+
+#endif //EXPRESSER_SYMBOLTABLE_H
@@ -0,0 +1,110 @@
+#include <cstdlib>
+#include <new>
+#include <string>
+
+#include "Lexer/Interner.h"
+#include "Lexer/Lexer.h"
+#include "Parser/Parser.h"
+#include "Test/Check.h"
+
+// 替换全局operator new，统计解析期间的全部分配，包括没有走memory_resource的
+static size_t allocations = 0;
+
+void *operator new(size_t size) {
+    allocations++;
+    if (void *p = std::malloc(size == 0 ? 1 : size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void *operator new(size_t size, std::align_val_t alignment) {
+    allocations++;
+    auto align = static_cast<size_t>(alignment);
+    if (void *p = std::aligned_alloc(align, (size + align - 1) / align * align))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+
+void operator delete(void *p, std::align_val_t) noexcept { std::free(p); }
+
+void operator delete(void *p, size_t, std::align_val_t) noexcept { std::free(p); }
+
+namespace {
+    // 解析一段程序期间的分配次数，程序必须合法
+    size_t parseAllocations(const std::string &program) {
+        expresser::Interner interner;
+        expresser::Lexer lex(program.data(), program.size(), interner);
+        expresser::Parser parser(lex, interner);
+        auto before = allocations;
+        auto err = parser.Parse();
+        auto after = allocations;
+        CHECK(!err.has_value());
+        CHECK(!parser.LexerError().has_value());
+        return after - before;
+    }
+
+    std::string repeat(const std::string &snippet, size_t count) {
+        std::string result;
+        for (size_t i = 0; i < count; i++)
+            result += snippet;
+        return result;
+    }
+
+    const std::string prologue =
+            "int f(int p, int q) { return p * q; }\n"
+            "void main() {\n"
+            "    int a = 1, b = 2, c = 3, x = 0;\n";
+    const std::string epilogue = "}\n";
+
+    // 每条语句、每个子表达式的分配预算：名字已驻留、常量已入池后不应再分配
+    constexpr size_t statement_budget = 0;
+    constexpr size_t expression_budget = 0;
+    // 代码量翻倍时CodeSink的操作码、操作数、label、回填四个vector各可能扩容一次
+    constexpr size_t regrowth_slack = 4;
+    constexpr size_t base_count = 200;
+
+    // 语句重复base_count次与2 * base_count次的分配次数之差
+    void checkStatement(const std::string &statement) {
+        auto once = parseAllocations(prologue + repeat(statement, base_count) + epilogue);
+        auto twice = parseAllocations(prologue + repeat(statement, 2 * base_count) + epilogue);
+        if (twice - once > statement_budget * base_count + regrowth_slack) {
+            std::cerr << statement << "  " << base_count << " more statements allocated " << twice - once
+                      << " times" << std::endl;
+            CHECK(twice - once <= statement_budget * base_count + regrowth_slack);
+        }
+    }
+
+    // 一个表达式中的项重复base_count次与2 * base_count次的分配次数之差
+    void checkExpression(const std::string &term) {
+        auto program = [&](size_t count) {
+            return prologue + "x = a" + repeat(term, count) + ";\n" + epilogue;
+        };
+        auto once = parseAllocations(program(base_count));
+        auto twice = parseAllocations(program(2 * base_count));
+        if (twice - once > expression_budget * base_count + regrowth_slack) {
+            std::cerr << "x = a" << term << "...  " << base_count << " more terms allocated " << twice - once
+                      << " times" << std::endl;
+            CHECK(twice - once <= expression_budget * base_count + regrowth_slack);
+        }
+    }
+}
+
+int main() {
+    checkStatement("x = a;\n");
+    checkStatement("x = (a + b) * c - a / 2 + f(a, c);\n");
+    checkStatement("if (x > 10) print(\"big\", x); else print('s', (char) x);\n");
+    checkStatement("while (a < 3) { a = a + 1; if (a == 2) continue; b = b - 1; }\n");
+    checkStatement("do { c = c - 1; if (c < -5) break; } while (c > 0);\n");
+    checkStatement("scan(b);\n");
+    checkStatement("print(a, b, c);\n");
+
+    checkExpression(" + b");
+    checkExpression(" + b * (c - a)");
+    checkExpression(" - f(b, (c + 1) * 2)");
+    checkExpression(" + (char) c");
+    return expresser::check_failures;
+}
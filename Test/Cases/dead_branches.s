@@ -0,0 +1,27 @@
+.constants:
+0 S "main"
+.start:
+.functions:
+0 0 0 1
+.F0:
+0 snew 1
+1 loada 0,0
+2 bipush 0
+3 istore
+4 bipush 4
+5 iprint
+6 printl
+7 bipush 6
+8 iprint
+9 printl
+10 loada 0,0
+11 loada 0,0
+12 iload
+13 bipush 1
+14 isub
+15 istore
+16 loada 0,0
+17 iload
+18 iprint
+19 printl
+20 ret
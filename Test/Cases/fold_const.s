@@ -0,0 +1,54 @@
+.constants:
+0 S "main"
+.start:
+0 snew 1
+1 loada 0,0
+2 bipush 42
+3 istore
+4 snew 1
+5 loada 0,1
+6 bipush 1
+7 istore
+.functions:
+0 0 0 1
+.F0:
+0 snew 1
+1 loada 0,0
+2 bipush 22
+3 istore
+4 snew 1
+5 loada 0,1
+6 loada 1,1
+7 iload
+8 bipush 1
+9 iadd
+10 istore
+11 snew 1
+12 loada 0,2
+13 bipush 98
+14 istore
+15 bipush 42
+16 iprint
+17 bipush 32
+18 cprint
+19 bipush 22
+20 iprint
+21 bipush 32
+22 cprint
+23 bipush 66
+24 iprint
+25 printl
+26 loada 0,1
+27 iload
+28 bipush 2
+29 imul
+30 iprint
+31 printl
+32 bipush 1
+33 cprint
+34 printl
+35 bipush 65
+36 i2c
+37 cprint
+38 printl
+39 ret
@@ -0,0 +1,25 @@
+.constants:
+0 S "main"
+.start:
+.functions:
+0 0 0 1
+.F0:
+0 bipush 1
+1 bipush 0
+2 idiv
+3 iprint
+4 printl
+5 bipush 7
+6 bipush 0
+7 idiv
+8 iprint
+9 printl
+10 ipush -2147483648
+11 ipush -1
+12 idiv
+13 iprint
+14 printl
+15 ipush -2147483648
+16 iprint
+17 printl
+18 ret
@@ -0,0 +1,31 @@
+.constants:
+0 S "main"
+.start:
+.functions:
+0 0 0 1
+.F0:
+0 bipush 0
+1 iprint
+2 printl
+3 bipush 127
+4 iprint
+5 printl
+6 ipush 128
+7 iprint
+8 printl
+9 bipush 127
+10 iprint
+11 printl
+12 ipush 128
+13 iprint
+14 printl
+15 ipush -1
+16 iprint
+17 printl
+18 ipush -1
+19 iprint
+20 printl
+21 ipush 255
+22 iprint
+23 printl
+24 ret
@@ -0,0 +1,34 @@
+.constants:
+0 S "main"
+.start:
+.functions:
+0 0 0 1
+.F0:
+0 ipush -2147483648
+1 iprint
+2 printl
+3 ipush 2147483647
+4 iprint
+5 printl
+6 bipush 0
+7 iprint
+8 printl
+9 ipush 131073
+10 iprint
+11 printl
+12 ipush -2147483648
+13 iprint
+14 printl
+15 ipush -3
+16 iprint
+17 printl
+18 bipush 13
+19 iprint
+20 printl
+21 bipush 98
+22 iprint
+23 printl
+24 bipush 97
+25 iprint
+26 printl
+27 ret
@@ -0,0 +1,76 @@
+.constants:
+0 S "f"
+1 S "main"
+.start:
+.functions:
+0 0 1 1
+1 1 0 1
+.F0:
+0 loada 0,0
+1 iload
+2 jle 17
+3 loada 0,0
+4 loada 0,0
+5 iload
+6 bipush 1
+7 isub
+8 istore
+9 loada 0,0
+10 iload
+11 bipush 3
+12 icmp
+13 jne 0
+14 loada 0,0
+15 iload
+16 iret
+17 loada 0,0
+18 iload
+19 iret
+.F1:
+0 snew 1
+1 loada 0,0
+2 bipush 0
+3 istore
+4 loada 0,0
+5 iload
+6 bipush 3
+7 icmp
+8 jge 20
+9 loada 0,0
+10 iload
+11 iprint
+12 printl
+13 loada 0,0
+14 loada 0,0
+15 iload
+16 bipush 1
+17 iadd
+18 istore
+19 jmp 4
+20 loada 0,0
+21 iscan
+22 istore
+23 loada 0,0
+24 iload
+25 jne 20
+26 loada 0,0
+27 iload
+28 call 0
+29 iprint
+30 printl
+31 loada 0,0
+32 loada 0,0
+33 iload
+34 bipush 1
+35 iadd
+36 istore
+37 loada 0,0
+38 iload
+39 bipush 5
+40 icmp
+41 jl 26
+42 loada 0,0
+43 iload
+44 iprint
+45 printl
+46 jmp 42
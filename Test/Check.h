@@ -0,0 +1,19 @@
+#ifndef EXPRESSER_CHECK_H
+#define EXPRESSER_CHECK_H
+
+#include <iostream>
+
+namespace expresser {
+    // 测试中失败的断言个数，main以此为返回值
+    inline int check_failures = 0;
+
+    inline void checkFailed(const char *condition, const char *file, int line) {
+        std::cerr << file << ":" << line << ": check failed: " << condition << std::endl;
+        check_failures++;
+    }
+}
+
+// 失败时打印位置并继续执行，一次运行报告所有失败
+#define CHECK(condition) ((condition) ? (void) 0 : expresser::checkFailed(#condition, __FILE__, __LINE__))
+
+#endif //EXPRESSER_CHECK_H
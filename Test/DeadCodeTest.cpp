@@ -0,0 +1,104 @@
+#include <cstdint>
+#include <iostream>
+
+#include "Instruction/CodeSink.h"
+#include "Optimizer/DeadCode.h"
+#include "Optimizer/Optimize.h"
+#include "Optimizer/Pass.h"
+#include "Optimizer/Peephole.h"
+#include "Test/Check.h"
+#include "Test/PassCheck.h"
+
+namespace {
+    using namespace expresser;
+
+    void checkCode(const char *name, const PassCode &result, const PassCode &expected) {
+        if (sameCode(result, expected))
+            return;
+        std::cerr << name << ": got" << std::endl;
+        printCode(result);
+        std::cerr << "  expected" << std::endl;
+        printCode(expected);
+        CHECK(false);
+    }
+
+    // 单独运行一次DeadCode
+    void checkDeadCode(const char *name, const PassCode &before, const PassCode &after, uint32_t folded, uint32_t removed) {
+        CodeSink code;
+        storeInstructions(code, before);
+        DeadCode dead_code;
+        bool changed = dead_code.Run(code);
+        checkCode(name, loadInstructions(code), after);
+        CHECK(dead_code.FoldedBranches() == folded);
+        CHECK(dead_code.RemovedInstructions() == removed);
+        CHECK(changed == !sameCode(before, after));
+    }
+
+    // 经main.cpp同样调用的optimizeToFixpoint，DeadCode与Peephole交替运行到不动点
+    void checkOptimized(const char *name, const PassCode &before, const PassCode &after) {
+        CodeSink code;
+        storeInstructions(code, before);
+        DeadCode dead_code;
+        Peephole peephole;
+        bool changed = optimizeToFixpoint(code, dead_code, peephole);
+        checkCode(name, loadInstructions(code), after);
+        CHECK(changed == !sameCode(before, after));
+    }
+}
+
+int main() {
+    // push c; jcc
+    checkDeadCode("push-branch taken",
+                  {{BIPUSH, {0}}, {JE, {4}}, {BIPUSH, {1}}, {IPRINT, {}}, {RET, {}}},
+                  {{NOP, {}}, {JMP, {2}}, {RET, {}}}, 1, 2);
+    checkDeadCode("push-branch not taken",
+                  {{BIPUSH, {0}}, {JNE, {4}}, {BIPUSH, {1}}, {IPRINT, {}}, {RET, {}}},
+                  {{NOP, {}}, {NOP, {}}, {BIPUSH, {1}}, {IPRINT, {}}, {RET, {}}}, 1, 0);
+
+    // push a; push b; icmp; jcc
+    checkDeadCode("compare taken",
+                  {{BIPUSH, {1}}, {IPUSH, {200}}, {ICMP, {}}, {JL, {6}}, {BIPUSH, {1}}, {IPRINT, {}}, {RET, {}}},
+                  {{NOP, {}}, {NOP, {}}, {NOP, {}}, {JMP, {4}}, {RET, {}}}, 1, 2);
+    checkDeadCode("compare not taken",
+                  {{BIPUSH, {1}}, {IPUSH, {200}}, {ICMP, {}}, {JGE, {6}}, {BIPUSH, {1}}, {IPRINT, {}}, {RET, {}}},
+                  {{NOP, {}}, {NOP, {}}, {NOP, {}}, {NOP, {}}, {BIPUSH, {1}}, {IPRINT, {}}, {RET, {}}}, 1, 0);
+    // icmp被跳转到时两个操作数不一定都是常量
+    checkDeadCode("compare with target",
+                  {{ISCAN, {}}, {JE, {3}}, {BIPUSH, {1}}, {BIPUSH, {2}}, {ICMP, {}}, {JE, {0}}, {RET, {}}},
+                  {{ISCAN, {}}, {JE, {3}}, {BIPUSH, {1}}, {BIPUSH, {2}}, {ICMP, {}}, {JE, {0}}, {RET, {}}}, 0, 0);
+
+    // 循环体只能经回边到达，跳出循环的条件不是常量时全部保留
+    checkDeadCode("loop body",
+                  {{JMP, {3}}, {BIPUSH, {1}}, {IPRINT, {}}, {ISCAN, {}}, {JNE, {1}}, {RET, {}}},
+                  {{JMP, {3}}, {BIPUSH, {1}}, {IPRINT, {}}, {ISCAN, {}}, {JNE, {1}}, {RET, {}}}, 0, 0);
+    // 死循环之后的代码不可达
+    checkDeadCode("endless loop",
+                  {{BIPUSH, {1}}, {IPRINT, {}}, {BIPUSH, {1}}, {JNE, {0}}, {BIPUSH, {2}}, {IPRINT, {}}, {RET, {}}},
+                  {{BIPUSH, {1}}, {IPRINT, {}}, {NOP, {}}, {JMP, {0}}}, 1, 3);
+    // ret之后、没有跳转到达的代码被删除，跳转目标随之前移
+    checkDeadCode("after return",
+                  {{ISCAN, {}}, {JE, {4}}, {RET, {}}, {IPRINT, {}}, {BIPUSH, {1}}, {IRET, {}}, {RET, {}}},
+                  {{ISCAN, {}}, {JE, {3}}, {RET, {}}, {BIPUSH, {1}}, {IRET, {}}}, 0, 2);
+
+    // 与Peephole交替到不动点：while (0)的循环体与跳转都消失
+    checkOptimized("while false",
+                   {{BIPUSH, {0}}, {JE, {5}}, {BIPUSH, {1}}, {IPRINT, {}}, {JMP, {0}}, {BIPUSH, {2}}, {IPRINT, {}},
+                    {RET, {}}},
+                   {{BIPUSH, {2}}, {IPRINT, {}}, {RET, {}}});
+    // if (1 > 2) print(1); else print(2);
+    checkOptimized("if false",
+                   {{BIPUSH, {1}}, {BIPUSH, {2}}, {ICMP, {}}, {JLE, {7}}, {BIPUSH, {1}}, {IPRINT, {}}, {JMP, {9}},
+                    {BIPUSH, {2}}, {IPRINT, {}}, {RET, {}}},
+                   {{BIPUSH, {2}}, {IPRINT, {}}, {RET, {}}});
+    // Peephole删除nop后DeadCode才能折叠，需要第二轮
+    checkOptimized("second round",
+                   {{BIPUSH, {0}}, {NOP, {}}, {JNE, {5}}, {BIPUSH, {1}}, {IPRINT, {}}, {RET, {}}},
+                   {{BIPUSH, {1}}, {IPRINT, {}}, {RET, {}}});
+    // while (i < 3)的回边使循环体保留
+    checkOptimized("loop back edge",
+                   {{LOADA, {0, 0}}, {ILOAD, {}}, {BIPUSH, {3}}, {ICMP, {}}, {JGE, {9}}, {LOADA, {0, 0}},
+                    {ILOAD, {}}, {IPRINT, {}}, {JMP, {0}}, {RET, {}}},
+                   {{LOADA, {0, 0}}, {ILOAD, {}}, {BIPUSH, {3}}, {ICMP, {}}, {JGE, {9}}, {LOADA, {0, 0}},
+                    {ILOAD, {}}, {IPRINT, {}}, {JMP, {0}}, {RET, {}}});
+    return expresser::check_failures;
+}
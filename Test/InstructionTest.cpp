@@ -0,0 +1,173 @@
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Instruction/Instruction.h"
+#include "Instruction/InstructionBuffer.h"
+#include "Lexer/Interner.h"
+#include "Lexer/Lexer.h"
+#include "Parser/Parser.h"
+#include "Test/Check.h"
+
+namespace {
+    using namespace expresser;
+
+    // 编码后再解码，指令与字节都应一致
+    void checkRoundTrip(const InstructionBuffer &instructions) {
+        std::vector<uint8_t> bytes(instructions.EncodedSize());
+        CHECK(instructions.Encode(bytes.data()) == bytes.data() + bytes.size());
+
+        InstructionBuffer decoded;
+        auto read = decoded.Decode(bytes.data(), bytes.size(), instructions.Size());
+        CHECK(read.has_value() && read.value() == bytes.size());
+        CHECK(decoded.Size() == instructions.Size());
+        CHECK(decoded.EncodedSize() == instructions.EncodedSize());
+        if (decoded.Size() != instructions.Size())
+            return;
+        auto it = decoded.begin();
+        for (const auto &instruction : instructions) {
+            auto other = *it;
+            CHECK(other.GetIndex() == instruction.GetIndex());
+            CHECK(other.GetOperation() == instruction.GetOperation());
+            for (uint8_t i = 0; i < instruction.GetOperandCount(); i++)
+                CHECK(other.GetOperand(i) == instruction.GetOperand(i));
+            ++it;
+        }
+
+        std::vector<uint8_t> again(decoded.EncodedSize());
+        decoded.Encode(again.data());
+        CHECK(again == bytes);
+    }
+
+    // 沿控制流求栈深度，相对进入代码段时的栈顶
+    // 深度不能为负，汇合处各条路径的深度必须相同，否则返回空
+    std::optional<int32_t> maxStackDepth(const InstructionBuffer &instructions, const Parser &parser) {
+        std::vector<Instruction> code(instructions.begin(), instructions.end());
+        auto functions = parser.FunctionsInOrder();
+        std::vector<std::optional<int32_t>> depth(code.size());
+        std::vector<uint32_t> worklist;
+        int32_t max_depth = 0;
+        bool consistent = true;
+        auto visit = [&](uint32_t index, int32_t value) {
+            if (index >= code.size())
+                return;
+            if (!depth[index].has_value()) {
+                depth[index] = value;
+                worklist.push_back(index);
+            } else if (depth[index].value() != value) {
+                consistent = false;
+            }
+        };
+        visit(0, 0);
+        while (!worklist.empty()) {
+            auto index = worklist.back();
+            worklist.pop_back();
+            const auto &instruction = code[index];
+            auto operation = instruction.GetOperation();
+            auto effect = instruction.StackEffect();
+            if (!effect.has_value()) {
+                // call：弹出参数，有返回值时压入一个slot
+                const auto *callee = functions[instruction.GetOperand(0)];
+                effect = (callee->_return_type == VOID ? 0 : 1) - callee->_params_size;
+            }
+            auto after = depth[index].value() + effect.value();
+            if (after < 0)
+                return {};
+            max_depth = std::max(max_depth, after);
+            if (isJump(operation))
+                visit(instruction.GetOperand(0), after);
+            if (operation != JMP && operation != RET && operation != IRET && operation != DRET && operation != ARET)
+                visit(index + 1, after);
+        }
+        if (!consistent)
+            return {};
+        return max_depth;
+    }
+
+    struct Compiled {
+        Interner _interner;
+        std::string _program;
+        Lexer _lexer;
+        Parser _parser;
+
+        explicit Compiled(std::string program) :
+                _program(std::move(program)), _lexer(_program.data(), _program.size(), _interner),
+                _parser(_lexer, _interner) {
+            auto err = _parser.Parse();
+            CHECK(!err.has_value());
+            CHECK(!_parser.LexerError().has_value());
+        }
+    };
+
+    const char *program =
+            "const int N = 10;\n"
+            "int g = 3;\n"
+            "char c = 'x';\n"
+            "int mul(int p, int q) { return p * q; }\n"
+            "int fib(int n) {\n"
+            "    if (n <= 1) return n;\n"
+            "    return fib(n - 1) + fib(n - 2);\n"
+            "}\n"
+            "void show(const int a, char b) { print(\"a =\", a, b, 70000, -129); }\n"
+            "void main() {\n"
+            "    int i = 0, s = 0;\n"
+            "    while (i < N) {\n"
+            "        s = s + mul(fib(i), 2) - i / 3;\n"
+            "        i = i + 1;\n"
+            "        if (s > 100) break;\n"
+            "    }\n"
+            "    do { i = i - 1; } while (i > 0);\n"
+            "    show(s, (char) 65);\n"
+            "    scan(g);\n"
+            "    print(g + c);\n"
+            "}\n";
+}
+
+int main() {
+    Compiled compiled(program);
+    const auto &parser = compiled._parser;
+    auto functions = parser.FunctionsInOrder();
+
+    // 每段代码都能无损地编码、解码
+    checkRoundTrip(parser._start_code.Instructions());
+    for (auto function : functions)
+        checkRoundTrip(function->_code.Instructions());
+
+    // 每个函数的栈深度都能静态确定
+    for (auto function : functions)
+        CHECK(maxStackDepth(function->_code.Instructions(), parser).has_value());
+    // .start段为三个全局变量各留一个slot，赋值时再压入地址和值
+    CHECK(maxStackDepth(parser._start_code.Instructions(), parser) == 5);
+    // loada p; iload; loada q; iload; imul; iret
+    CHECK(maxStackDepth(functions[0]->_code.Instructions(), parser) == 2);
+
+    // 非法操作码和不完整的指令解码失败
+    {
+        const uint8_t invalid[] = {0xff};
+        InstructionBuffer decoded;
+        CHECK(!decoded.Decode(invalid, sizeof(invalid), 1).has_value());
+        // ipush的操作数应有4字节
+        const uint8_t truncated[] = {IPUSH, 0x00, 0x01};
+        CHECK(!decoded.Decode(truncated, sizeof(truncated), 1).has_value());
+        const uint8_t short_count[] = {NOP};
+        CHECK(!decoded.Decode(short_count, sizeof(short_count), 2).has_value());
+    }
+
+    // 栈效果与规格表一致，popn和snew取决于操作数
+    {
+        InstructionBuffer buffer;
+        buffer.Append(IADD, {});
+        buffer.Append(DUP2, {});
+        buffer.Append(POPN, {3});
+        buffer.Append(SNEW, {2});
+        buffer.Append(CALL, {0});
+        std::vector<Instruction> code(buffer.begin(), buffer.end());
+        CHECK(code[0].StackEffect() == -1);
+        CHECK(code[1].StackEffect() == 2);
+        CHECK(code[2].StackEffect() == -3);
+        CHECK(code[3].StackEffect() == 2);
+        CHECK(!code[4].StackEffect().has_value());
+    }
+    return expresser::check_failures;
+}
@@ -0,0 +1,64 @@
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "Lexer/Interner.h"
+#include "Lexer/Lexer.h"
+#include "Parser/Parser.h"
+#include "Test/Check.h"
+
+namespace {
+    using namespace expresser;
+
+    // 长度为length的标识符和字符串字面量都能完整地词法分析、编译
+    void checkLongTokens(size_t length) {
+        std::string name(length, 'v');
+        std::string text(length, 's');
+        std::string program = "int " + name + ";\n"
+                              "void main() {\n"
+                              "    scan(" + name + ");\n"
+                              "    print(\"" + text + "\", " + name + ");\n"
+                              "}\n";
+
+        Interner interner;
+        Lexer lexer(program.data(), program.size(), interner);
+        auto[tokens, err] = lexer.AllTokens();
+        CHECK(!err.has_value());
+        bool found_name = false, found_text = false;
+        for (const auto &token : tokens) {
+            if (token.GetType() == IDENTIFIER && lexer.GetText(token) == name) {
+                found_name = true;
+                CHECK(token.GetLength() == length);
+                CHECK(interner.Get(token.GetSymbol()) == name);
+            } else if (token.GetType() == STRINGLITERAL) {
+                found_text = true;
+                // 原文包括两侧的引号
+                CHECK(token.GetLength() == length + 2);
+                CHECK(token.GetEndOffset() == token.GetOffset() + length + 2);
+                CHECK(interner.Get(token.GetSymbol()) == text);
+            }
+        }
+        CHECK(found_name);
+        CHECK(found_text);
+
+        Interner parser_interner;
+        Lexer parser_lexer(program.data(), program.size(), parser_interner);
+        Parser parser(parser_lexer, parser_interner);
+        CHECK(!parser.Parse().has_value());
+        CHECK(!parser.LexerError().has_value());
+        bool found_constant = false;
+        for (const auto &constant : parser._global_constants)
+            if (constant._type == 'S' && std::get<std::string_view>(constant._value) == text)
+                found_constant = true;
+        CHECK(found_constant);
+    }
+}
+
+int main() {
+    // 原文长度超过16位的token
+    checkLongTokens(UINT16_MAX - 2);
+    checkLongTokens(UINT16_MAX);
+    checkLongTokens(UINT16_MAX + 1);
+    checkLongTokens(1 << 20);
+    return expresser::check_failures;
+}
@@ -0,0 +1,39 @@
+#ifndef EXPRESSER_PASSCHECK_H
+#define EXPRESSER_PASSCHECK_H
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "Optimizer/Pass.h"
+
+namespace expresser {
+    // 优化pass测试中手写的代码
+    using PassCode = std::vector<PassInstruction>;
+
+    // 只比较各指令实际使用的操作数
+    inline bool sameCode(const PassCode &lhs, const PassCode &rhs) {
+        if (lhs.size() != rhs.size())
+            return false;
+        for (size_t i = 0; i < lhs.size(); i++) {
+            if (lhs[i]._operation != rhs[i]._operation)
+                return false;
+            for (uint8_t j = 0; j < operandWidths(lhs[i]._operation).Count(); j++)
+                if (lhs[i]._operands[j] != rhs[i]._operands[j])
+                    return false;
+        }
+        return true;
+    }
+
+    // 按汇编格式打印到stderr，供失败时对照
+    inline void printCode(const PassCode &code) {
+        for (size_t i = 0; i < code.size(); i++) {
+            std::cerr << "    " << i << " " << operationSpec(code[i]._operation)._mnemonic;
+            for (uint8_t j = 0; j < operandWidths(code[i]._operation).Count(); j++)
+                std::cerr << (j == 0 ? " " : ",") << code[i]._operands[j];
+            std::cerr << std::endl;
+        }
+    }
+}
+
+#endif //EXPRESSER_PASSCHECK_H
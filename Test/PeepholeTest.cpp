@@ -0,0 +1,145 @@
+#include <cstdint>
+#include <iostream>
+#include <string_view>
+
+#include "Instruction/CodeSink.h"
+#include "Optimizer/Pass.h"
+#include "Optimizer/Peephole.h"
+#include "Test/Check.h"
+#include "Test/PassCheck.h"
+
+namespace {
+    using namespace expresser;
+
+    uint32_t ruleHits(const Peephole &peephole, std::string_view rule) {
+        for (size_t i = 0; i < peephole_rules.size(); i++)
+            if (peephole_rules[i]._name == rule)
+                return peephole.Hits()[i];
+        std::cerr << "unknown rule " << rule << std::endl;
+        CHECK(false);
+        return 0;
+    }
+
+    // 对before运行窥孔优化到不动点，结果须为after，rule命中hits次
+    void checkRule(std::string_view rule, const PassCode &before, const PassCode &after, uint32_t hits) {
+        CodeSink code;
+        storeInstructions(code, before);
+        Peephole peephole;
+        bool changed = peephole.Run(code);
+        auto result = loadInstructions(code);
+        if (!sameCode(result, after) || ruleHits(peephole, rule) != hits) {
+            std::cerr << rule << ": " << ruleHits(peephole, rule) << " hits, got" << std::endl;
+            printCode(result);
+            std::cerr << "  expected " << hits << " hits" << std::endl;
+            printCode(after);
+            CHECK(sameCode(result, after));
+            CHECK(ruleHits(peephole, rule) == hits);
+        }
+        CHECK(changed == !sameCode(before, after));
+    }
+}
+
+int main() {
+    // nop
+    checkRule("nop",
+              {{BIPUSH, {1}}, {NOP, {}}, {NOP, {}}, {IPRINT, {}}, {RET, {}}},
+              {{BIPUSH, {1}}, {IPRINT, {}}, {RET, {}}}, 2);
+    // 跳到被删除的指令时改为跳到其后第一条保留的指令
+    checkRule("nop",
+              {{NOP, {}}, {BIPUSH, {1}}, {IPRINT, {}}, {JMP, {0}}},
+              {{BIPUSH, {1}}, {IPRINT, {}}, {JMP, {0}}}, 1);
+
+    // jump-to-next
+    checkRule("jump-to-next",
+              {{JMP, {1}}, {BIPUSH, {1}}, {IPRINT, {}}, {RET, {}}},
+              {{BIPUSH, {1}}, {IPRINT, {}}, {RET, {}}}, 1);
+    // 删除后其后的跳转目标前移
+    checkRule("jump-to-next",
+              {{ISCAN, {}}, {JMP, {2}}, {JE, {0}}, {RET, {}}},
+              {{ISCAN, {}}, {JE, {0}}, {RET, {}}}, 1);
+
+    // branch-to-next：条件仍需弹出
+    checkRule("branch-to-next",
+              {{ISCAN, {}}, {JE, {2}}, {RET, {}}},
+              {{ISCAN, {}}, {POP, {}}, {RET, {}}}, 1);
+
+    // branch-over-jump：每种条件跳转都按reverse_map取反
+    for (const auto &[branch, inverse] : reverse_map) {
+        checkRule("branch-over-jump",
+                  {{ISCAN, {}}, {branch, {3}}, {JMP, {5}}, {BIPUSH, {1}}, {IPRINT, {}}, {BIPUSH, {2}}, {IPRINT, {}},
+                   {RET, {}}},
+                  {{ISCAN, {}}, {inverse, {4}}, {BIPUSH, {1}}, {IPRINT, {}}, {BIPUSH, {2}}, {IPRINT, {}}, {RET, {}}},
+                  1);
+    }
+    // jmp被跳转到时不能并入窗口，自环的jmp不会被thread-jump穿透
+    checkRule("branch-over-jump",
+              {{ISCAN, {}}, {JE, {3}}, {JMP, {2}}, {ISCAN, {}}, {JNE, {2}}, {RET, {}}},
+              {{ISCAN, {}}, {JE, {3}}, {JMP, {2}}, {ISCAN, {}}, {JNE, {2}}, {RET, {}}}, 0);
+
+    // compare-zero
+    checkRule("compare-zero",
+              {{ISCAN, {}}, {BIPUSH, {0}}, {ICMP, {}}, {JG, {6}}, {BIPUSH, {1}}, {IPRINT, {}}, {RET, {}}},
+              {{ISCAN, {}}, {JG, {4}}, {BIPUSH, {1}}, {IPRINT, {}}, {RET, {}}}, 1);
+    checkRule("compare-zero",
+              {{ISCAN, {}}, {IPUSH, {0}}, {ICMP, {}}, {JNE, {0}}, {RET, {}}},
+              {{ISCAN, {}}, {JNE, {0}}, {RET, {}}}, 1);
+    // 与非0比较不能省略
+    checkRule("compare-zero",
+              {{ISCAN, {}}, {BIPUSH, {1}}, {ICMP, {}}, {JNE, {0}}, {RET, {}}},
+              {{ISCAN, {}}, {BIPUSH, {1}}, {ICMP, {}}, {JNE, {0}}, {RET, {}}}, 0);
+    // icmp被跳转到时窗口中间有跳转目标
+    checkRule("compare-zero",
+              {{ISCAN, {}}, {BIPUSH, {0}}, {ICMP, {}}, {JNE, {2}}, {RET, {}}},
+              {{ISCAN, {}}, {BIPUSH, {0}}, {ICMP, {}}, {JNE, {2}}, {RET, {}}}, 0);
+
+    // double-i2c
+    checkRule("double-i2c",
+              {{ISCAN, {}}, {I2C, {}}, {I2C, {}}, {CPRINT, {}}, {RET, {}}},
+              {{ISCAN, {}}, {I2C, {}}, {CPRINT, {}}, {RET, {}}}, 1);
+    checkRule("double-i2c",
+              {{ISCAN, {}}, {I2C, {}}, {I2C, {}}, {CPRINT, {}}, {JMP, {2}}},
+              {{ISCAN, {}}, {I2C, {}}, {I2C, {}}, {CPRINT, {}}, {JMP, {2}}}, 0);
+
+    // push-pop
+    checkRule("push-pop",
+              {{BIPUSH, {5}}, {POP, {}}, {LOADA, {0, 1}}, {POP, {}}, {LOADC, {0}}, {POP, {}}, {RET, {}}},
+              {{RET, {}}}, 3);
+    // pop被跳转到时保留
+    checkRule("push-pop",
+              {{ISCAN, {}}, {JE, {3}}, {BIPUSH, {1}}, {POP, {}}, {RET, {}}},
+              {{ISCAN, {}}, {JE, {3}}, {BIPUSH, {1}}, {POP, {}}, {RET, {}}}, 0);
+    // 有副作用的压栈不能删除
+    checkRule("push-pop",
+              {{ISCAN, {}}, {POP, {}}, {RET, {}}},
+              {{ISCAN, {}}, {POP, {}}, {RET, {}}}, 0);
+
+    // thread-jump：跳转穿过jmp链
+    checkRule("thread-jump",
+              {{ISCAN, {}}, {JE, {3}}, {RET, {}}, {JMP, {5}}, {RET, {}}, {JMP, {7}}, {RET, {}}, {BIPUSH, {1}},
+               {IPRINT, {}}, {JMP, {0}}},
+              {{ISCAN, {}}, {JE, {7}}, {RET, {}}, {JMP, {7}}, {RET, {}}, {JMP, {7}}, {RET, {}}, {BIPUSH, {1}},
+               {IPRINT, {}}, {JMP, {0}}}, 2);
+    // 自环和jmp构成的环不会被穿透，也不会死循环
+    checkRule("thread-jump",
+              {{JMP, {0}}},
+              {{JMP, {0}}}, 0);
+    checkRule("thread-jump",
+              {{JMP, {2}}, {RET, {}}, {JMP, {0}}},
+              {{JMP, {2}}, {RET, {}}, {JMP, {0}}}, 0);
+    checkRule("thread-jump",
+              {{ISCAN, {}}, {JE, {3}}, {RET, {}}, {JMP, {5}}, {RET, {}}, {JMP, {3}}},
+              {{ISCAN, {}}, {JE, {3}}, {RET, {}}, {JMP, {5}}, {RET, {}}, {JMP, {3}}}, 0);
+
+    // jump-to-return：jmp→jmp→ret先穿过链，再把jmp换成ret
+    checkRule("thread-jump",
+              {{BIPUSH, {1}}, {JMP, {4}}, {BIPUSH, {2}}, {IPRINT, {}}, {JMP, {6}}, {IPRINT, {}}, {IRET, {}}},
+              {{BIPUSH, {1}}, {IRET, {}}, {BIPUSH, {2}}, {IPRINT, {}}, {IRET, {}}, {IPRINT, {}}, {IRET, {}}}, 1);
+    checkRule("jump-to-return",
+              {{BIPUSH, {1}}, {JMP, {4}}, {BIPUSH, {2}}, {IPRINT, {}}, {JMP, {6}}, {IPRINT, {}}, {IRET, {}}},
+              {{BIPUSH, {1}}, {IRET, {}}, {BIPUSH, {2}}, {IPRINT, {}}, {IRET, {}}, {IPRINT, {}}, {IRET, {}}}, 2);
+    // 条件跳转不能换成ret
+    checkRule("jump-to-return",
+              {{ISCAN, {}}, {JE, {3}}, {IPRINT, {}}, {RET, {}}},
+              {{ISCAN, {}}, {JE, {3}}, {IPRINT, {}}, {RET, {}}}, 0);
+    return expresser::check_failures;
+}
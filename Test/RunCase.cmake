@@ -0,0 +1,25 @@
+# 用cc0 -s编译CASE.c0，输出须与CASE.s逐字节相同
+# 存在CASE.err时编译须失败，错误输出须与CASE.err相同
+# cmake -DCC0=<cc0> -DCASE=<不带后缀的路径> -DOUTPUT=<输出文件> -P RunCase.cmake
+execute_process(COMMAND ${CC0} -s ${CASE}.c0 -o ${OUTPUT}
+        RESULT_VARIABLE result
+        ERROR_VARIABLE error)
+if(EXISTS ${CASE}.err)
+    file(READ ${CASE}.err expected)
+    if(result EQUAL 0)
+        message(FATAL_ERROR "cc0 accepted ${CASE}.c0, expected:\n${expected}")
+    endif()
+    if(NOT error STREQUAL expected)
+        message(FATAL_ERROR "${CASE}.err mismatch, got:\n${error}")
+    endif()
+    return()
+endif()
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "cc0 failed (${result}): ${error}")
+endif()
+
+file(READ ${CASE}.s expected)
+file(READ ${OUTPUT} actual)
+if(NOT actual STREQUAL expected)
+    message(FATAL_ERROR "${CASE}.s mismatch, got:\n${actual}")
+endif()
@@ -4,5 +4,7 @@
 #include <cstdint>
 
 typedef std::pair<uint32_t, uint32_t> position_t;
+// Interner分配的符号id
+typedef uint32_t symbol_t;
 
 #endif //EXPRESSER_TYPES_H
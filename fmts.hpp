@@ -8,6 +8,7 @@
 #include "Error/Error.h"
 #include "Lexer/Token.h"
 #include "Instruction/Instruction.h"
+#include "Parser/Parser.h"
 
 namespace fmt {
     template<>
@@ -201,9 +202,23 @@ namespace fmt {
         constexpr auto parse(ParseContext &ctx) { return ctx.begin(); }
 
         template<typename FormatContext>
-        auto format(expresser::Token p, FormatContext &ctx) {
-            return format_to(ctx.out(), "Line: {} Column: {} Type: {} Value: {}",
-                             p.GetStartPos().first, p.GetStartPos().second, p.GetType(), p.GetStringValue());
+        auto format(const expresser::Token &p, FormatContext &ctx) {
+            switch (p.GetType()) {
+                case expresser::INTEGER:
+                case expresser::CHARLITERAL:
+                    return format_to(ctx.out(), "Offset: {} Type: {} Value: {}",
+                                     p.GetOffset(), p.GetType(), p.GetIntValue());
+                case expresser::DOUBLE:
+                    return format_to(ctx.out(), "Offset: {} Type: {} Value: {}",
+                                     p.GetOffset(), p.GetType(), p.GetDoubleValue());
+                case expresser::RESERVED:
+                    return format_to(ctx.out(), "Offset: {} Type: {} Value: {}",
+                                     p.GetOffset(), p.GetType(),
+                                     expresser::keyword_names[static_cast<size_t>(p.GetKeyword())]);
+                default:
+                    return format_to(ctx.out(), "Offset: {} Type: {} Symbol: {}",
+                                     p.GetOffset(), p.GetType(), p.GetSymbol());
+            }
         }
     };
 
@@ -304,25 +319,33 @@ namespace fmt {
         constexpr auto parse(ParseContext &ctx) { return ctx.begin(); }
 
         template<typename FormatContext>
-        auto format(expresser::Instruction inst, FormatContext &ctx) {
-            auto params = inst.GetParams();
-            std::string string_param;
-            for (;;) {
-                int32_t value;
-                if (params.first._size == 0)
-                    break;
-                value = 0;
-                ::memcpy(&value, params.first._value, params.first._size);
-                string_param += " ";
-                string_param += std::to_string(value);
-                if (params.second._size == 0)
-                    break;
-                value = 0;
-                ::memcpy(&value, params.second._value, params.second._size);
-                string_param += "," + std::to_string(value);
-                break;
+        auto format(const expresser::Instruction &inst, FormatContext &ctx) {
+            auto out = format_to(ctx.out(), "{} {}", inst.GetIndex(), inst.GetOperation());
+            for (uint8_t i = 0; i < inst.GetOperandCount(); i++)
+                out = format_to(out, i == 0 ? " {}" : ",{}", inst.GetOperand(i));
+            return out;
+        }
+    };
+
+    template<>
+    struct formatter<expresser::Constant> {
+        template<typename ParseContext>
+        constexpr auto parse(ParseContext &ctx) { return ctx.begin(); }
+
+        template<typename FormatContext>
+        auto format(const expresser::Constant &constant, FormatContext &ctx) {
+            switch (constant._type) {
+                case 'D':
+                    return format_to(ctx.out(), "{} D {}", constant._index, std::get<double>(constant._value));
+                case 'I':
+                    return format_to(ctx.out(), "{} I {}", constant._index, std::get<int32_t>(constant._value));
+                case 'S':
+                    return format_to(ctx.out(), "{} S \"{}\"", constant._index,
+                                     std::get<std::string_view>(constant._value));
+                default:
+                    expresser::ExceptionPrint("Unknown contant type\n");
+                    exit(3);
             }
-            return format_to(ctx.out(), "{} {}{}", std::to_string(inst.GetIndex()), inst.GetOperation(), string_param);
         }
     };
 
@@ -333,187 +356,7 @@ namespace fmt {
 
         template<typename FormatContext>
         auto format(const expresser::Operation &op, FormatContext &ctx) {
-            std::string name;
-            switch (op) {
-                case expresser::NOP:
-                    name = "nop";
-                    break;
-                case expresser::BIPUSH:
-                    name = "bipush";
-                    break;
-                case expresser::IPUSH:
-                    name = "ipush";
-                    break;
-                case expresser::POP:
-                    name = "pop";
-                    break;
-                case expresser::POP2:
-                    name = "pop2";
-                    break;
-                case expresser::POPN:
-                    name = "popn";
-                    break;
-                case expresser::DUP:
-                    name = "dup";
-                    break;
-                case expresser::DUP2:
-                    name = "dup2";
-                    break;
-                case expresser::LOADC:
-                    name = "loadc";
-                    break;
-                case expresser::LOADA:
-                    name = "loada";
-                    break;
-                case expresser::NEW:
-                    name = "new";
-                    break;
-                case expresser::SNEW:
-                    name = "snew";
-                    break;
-                case expresser::ILOAD:
-                    name = "iload";
-                    break;
-                case expresser::DLOAD:
-                    name = "dload";
-                    break;
-                case expresser::ALOAD:
-                    name = "aload";
-                    break;
-                case expresser::IALOAD:
-                    name = "iaload";
-                    break;
-                case expresser::DALOAD:
-                    name = "daload";
-                    break;
-                case expresser::AALOAD:
-                    name = "aaload";
-                    break;
-                case expresser::ISTORE:
-                    name = "istore";
-                    break;
-                case expresser::DSTORE:
-                    name = "dstore";
-                    break;
-                case expresser::ASTORE:
-                    name = "astore";
-                    break;
-                case expresser::IASTORE:
-                    name = "iastore";
-                    break;
-                case expresser::DASTORE:
-                    name = "dastore";
-                    break;
-                case expresser::AASTORE:
-                    name = "aastore";
-                    break;
-                case expresser::IADD:
-                    name = "iadd";
-                    break;
-                case expresser::DADD:
-                    name = "dadd";
-                    break;
-                case expresser::ISUB:
-                    name = "isub";
-                    break;
-                case expresser::DSUB:
-                    name = "dsub";
-                    break;
-                case expresser::IMUL:
-                    name = "imul";
-                    break;
-                case expresser::DMUL:
-                    name = "dmul";
-                    break;
-                case expresser::IDIV:
-                    name = "idiv";
-                    break;
-                case expresser::DDIV:
-                    name = "ddiv";
-                    break;
-                case expresser::INEG:
-                    name = "ineg";
-                    break;
-                case expresser::DNEG:
-                    name = "dneg";
-                    break;
-                case expresser::ICMP:
-                    name = "icmp";
-                    break;
-                case expresser::DCMP:
-                    name = "dcmp";
-                    break;
-                case expresser::I2D:
-                    name = "i2d";
-                    break;
-                case expresser::D2I:
-                    name = "d2i";
-                    break;
-                case expresser::I2C:
-                    name = "i2c";
-                    break;
-                case expresser::JMP:
-                    name = "jmp";
-                    break;
-                case expresser::JE:
-                    name = "je";
-                    break;
-                case expresser::JNE:
-                    name = "jne";
-                    break;
-                case expresser::JL:
-                    name = "jl";
-                    break;
-                case expresser::JGE:
-                    name = "jge";
-                    break;
-                case expresser::JG:
-                    name = "jg";
-                    break;
-                case expresser::JLE:
-                    name = "jle";
-                    break;
-                case expresser::CALL:
-                    name = "call";
-                    break;
-                case expresser::RET:
-                    name = "ret";
-                    break;
-                case expresser::IRET:
-                    name = "iret";
-                    break;
-                case expresser::DRET:
-                    name = "dret";
-                    break;
-                case expresser::ARET:
-                    name = "aret";
-                    break;
-                case expresser::IPRINT:
-                    name = "iprint";
-                    break;
-                case expresser::DPRINT:
-                    name = "dprint";
-                    break;
-                case expresser::CPRINT:
-                    name = "cprint";
-                    break;
-                case expresser::SPRINT:
-                    name = "sprint";
-                    break;
-                case expresser::PRINTL:
-                    name = "printl";
-                    break;
-                case expresser::ISCAN:
-                    name = "iscan";
-                    break;
-                case expresser::DSCAN:
-                    name = "dscan";
-                    break;
-                case expresser::CSCAN:
-                    name = "cscan";
-                    break;
-            }
-            return format_to(ctx.out(), name);
+            return format_to(ctx.out(), "{}", expresser::operationSpec(op)._mnemonic);
         }
     };
 }
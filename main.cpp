@@ -1,77 +1,113 @@
 #include <algorithm>
 #include <fstream>
+#include <iterator>
 #include <iostream>
 #include <vector>
 
 #include "argparse.hpp"
 #include "fmt/core.h"
+#include "fmt/format.h"
 
+#include "Arena.h"
 #include "Binary.h"
 #include "fmts.hpp"
 #include "Lexer/Lexer.h"
+#include "Optimizer/Optimize.h"
 #include "Parser/Parser.h"
 
-std::vector<expresser::Token> _allToken(std::istream &_input) {
-    expresser::Lexer lex(_input);
-    auto res = lex.AllTokens();
-    if (res.second.has_value()) {
-        fmt::print(stderr, "Lexer error: {}\n", res.second.value());
+// 编译期间的数据结构都从这里分配，多次编译复用同一块内存
+static expresser::Arena arena;
+
+void _parse(expresser::Lexer &lex, expresser::Parser &parser) {
+    auto err = parser.Parse();
+    // Parser遇到词法错误时只会看到token流提前结束，以词法错误为准
+    auto lexer_err = parser.LexerError();
+    if (lexer_err.has_value()) {
+        fmt::print(stderr, "Lexer error: {}\n", lex.Locate(lexer_err.value()));
+        exit(2);
+    }
+    if (err.has_value()) {
+        fmt::print(stderr, "Parser error: {}\n", lex.Locate(err.value()));
         exit(2);
     }
-    return res.first;
 }
 
-void write_assembly_to_file(const expresser::Parser &_parser, std::ostream &_output) {
-    _output << ".constants:\n";
-    for (auto constant:_parser._global_constants) {
-        _output << fmt::format("{}\n", constant.ToCode());
+// 代码生成结束后的优化
+void _optimize(expresser::Parser &parser, bool print_stats) {
+    expresser::DeadCode dead_code;
+    expresser::Peephole peephole;
+    expresser::optimizeToFixpoint(parser._start_code, dead_code, peephole);
+    for (auto &function:parser._functions)
+        expresser::optimizeToFixpoint(function.second._code, dead_code, peephole);
+    if (print_stats) {
+        fmt::print(stderr, "dead code: {} branches folded, {} instructions removed\n",
+                   dead_code.FoldedBranches(), dead_code.RemovedInstructions());
+        for (size_t i = 0; i < expresser::peephole_rules.size(); i++)
+            fmt::print(stderr, "peephole {}: {}\n", expresser::peephole_rules[i]._name, peephole.Hits()[i]);
     }
-    _output << ".start:\n";
-    for (expresser::Instruction instrument:_parser._start_instruments) {
-        _output << fmt::format("{}\n", instrument);
+}
+
+void write_assembly_to_file(const expresser::Parser &_parser, std::ostream &_output) {
+    // 格式化到同一块缓冲区，攒够一块再写出
+    constexpr size_t flush_size = 64 * 1024;
+    fmt::memory_buffer buffer;
+    auto out = std::back_inserter(buffer);
+    auto flush = [&](size_t threshold) {
+        if (buffer.size() < threshold)
+            return;
+        _output.write(buffer.data(), buffer.size());
+        buffer.clear();
+    };
+
+    fmt::format_to(out, ".constants:\n");
+    for (const auto &constant:_parser._global_constants) {
+        fmt::format_to(out, "{}\n", constant);
+        flush(flush_size);
     }
-    auto functions = _parser._functions;
-    std::vector<std::pair<int32_t, std::string>> function_information;
-    function_information.reserve(functions.size());
-    for (const auto &function:functions) {
-        function_information.emplace_back(std::make_pair(function.second._index, function.first));
+    fmt::format_to(out, ".start:\n");
+    for (const auto &instrument:_parser._start_code.Instructions()) {
+        fmt::format_to(out, "{}\n", instrument);
+        flush(flush_size);
     }
-    std::sort(function_information.begin(), function_information.end());
-    _output << ".functions:\n";
-    for (const auto &it:function_information) {
-        auto function = functions.find(it.second);
-        _output << fmt::format("{} {} {} {}\n", function->second._index, function->second._name_index,
-                               function->second._params_size, function->second._level);
+    auto functions = _parser.FunctionsInOrder();
+    fmt::format_to(out, ".functions:\n");
+    for (auto function:functions) {
+        fmt::format_to(out, "{} {} {} {}\n", function->_index, function->_name_index,
+                       function->_params_size, function->_level);
+        flush(flush_size);
     }
-    for (const auto &it:function_information) {
-        auto function = functions.find(it.second);
-        _output << fmt::format(".F{}:\n", it.first);
-        for (const auto &instrument:function->second._instructions) {
-            _output << fmt::format("{}\n", instrument);
+    for (auto function:functions) {
+        fmt::format_to(out, ".F{}:\n", function->_index);
+        for (const auto &instrument:function->_code.Instructions()) {
+            fmt::format_to(out, "{}\n", instrument);
+            flush(flush_size);
         }
     }
+    flush(0);
 }
 
 
-void assembly(std::istream &_input, std::ostream &_output) {
-    auto tks = _allToken(_input);
-    expresser::Parser parser(tks);
-    auto err = parser.Parse();
-    if (err.has_value()) {
-        fmt::print(stderr, "Parser error: {}\n", err.value());
-        exit(2);
-    }
+void assembly(expresser::Source _input, std::ostream &_output, bool print_stats) {
+    // 上一次编译的对象都已析构
+    arena.Reset();
+    // Lexer与Parser共享字符串驻留表
+    expresser::Interner interner(arena.Resource());
+    expresser::Lexer lex(std::move(_input), interner);
+    expresser::Parser parser(lex, interner, arena.Resource());
+    _parse(lex, parser);
+    _optimize(parser, print_stats);
     write_assembly_to_file(parser, _output);
 }
 
-void binary(std::istream &_input, std::ostream &_output) {
-    auto tks = _allToken(_input);
-    expresser::Parser parser(tks);
-    auto err = parser.Parse();
-    if (err.has_value()) {
-        fmt::print(stderr, "Parser error: {}\n", err.value());
-        exit(2);
-    }
+void binary(expresser::Source _input, std::ostream &_output, bool print_stats) {
+    // 上一次编译的对象都已析构
+    arena.Reset();
+    // Lexer与Parser共享字符串驻留表
+    expresser::Interner interner(arena.Resource());
+    expresser::Lexer lex(std::move(_input), interner);
+    expresser::Parser parser(lex, interner, arena.Resource());
+    _parse(lex, parser);
+    _optimize(parser, print_stats);
     write_binary_to_file(parser, _output);
 }
 
@@ -88,6 +124,10 @@ int main(int argc, char **argv) {
             .default_value(false)
             .implicit_value(true)
             .help("Assembly");
+    arg.add_argument("--stats")
+            .default_value(false)
+            .implicit_value(true)
+            .help("Print optimizer statistics");
     arg.add_argument("-o", "--output")
             .default_value(std::string(""))
             .help("Output file");
@@ -102,20 +142,20 @@ int main(int argc, char **argv) {
 
     auto input_file = arg.get<std::string>("input");
     auto output_file = arg.get<std::string>("--output");
-    std::istream *input;
+    std::optional<expresser::Source> input;
     std::ostream *output;
-    std::ifstream infs;
     std::ofstream outfs;
     if (input_file.empty()) {
         std::cerr << "No input file" << std::endl;
         exit(3);
     } else {
-        infs.open(input_file, std::ios::in);
-        if (!infs) {
+        // 直接映射输入文件，词法分析在同一块缓冲区上进行
+        auto res = expresser::Source::FromFile(input_file);
+        if (res.second.has_value()) {
             std::cerr << "Open file " << input_file << " error" << std::endl;
             exit(3);
         }
-        input = &infs;
+        input = std::move(res.first);
     }
 
     if (output_file.empty()) {
@@ -136,9 +176,9 @@ int main(int argc, char **argv) {
         exit(2);
     }
     if (arg["-s"] == true)
-        assembly(*input, *output);
+        assembly(std::move(input.value()), *output, arg["--stats"] == true);
     else if (arg["-c"] == true)
-        binary(*input, *output);
+        binary(std::move(input.value()), *output, arg["--stats"] == true);
     else
         std::cerr << "Must choose running lexer or parser" << std::endl;
     return 0;